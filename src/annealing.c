@@ -21,81 +21,162 @@
 #include "annealing.h"
 
 
-int metropolis_criterion(double new_f, double current_f, double t) {
+sa_config create_sa_config(void) {
+  sa_config config;
+  config.cooling = FIXED_COOLING;
+  config.reheat = 0;
+  config.t0 = 500;
+  config.alpha = 0.95;
+  config.t_frozen = 1e-05;
+  return(config);
+}
+
+int metropolis_criterion(double new_f, double current_f, double t, uint64_t *random_state) {
   if (new_f - current_f >= 0) {
     return 1; // Accept new solution if higher value of the objective
   } else {
     double proba = exp((new_f - current_f) / t);
     // Randomly decide if new solution is accepted
-    return (((double)rand() / (double)RAND_MAX) < proba);
+    return (random_uniform(random_state) < proba);
   }
 }
 
-solution *simulated_annealing(const problem const *p, float max_time) {
-  timer_t timer = create_timer(max_time);
+void annealing_move(solution *s, undo_log *undo, repair_engine *r, const problem *p,
+                    uint64_t *random_state) {
+  int i = random_int(random_state, p->n); // Randomly select bit to flip
+  if (s->sol[i] == 0) {
+    // Add item if not present in solution
+    flip_item(s, i, undo, p);
+  } else {
+    // Remove item if present in solution and add another one.
+    // Among a few random proposals, the most profitable feasible
+    // insertion is preferred; otherwise the first one is used.
+    flip_item(s, i, undo, p);
+    int proposals[ANNEALING_N_PROPOSALS];
+    int n_violated[ANNEALING_N_PROPOSALS];
+    int delta[ANNEALING_N_PROPOSALS];
+    for (int b = 0 ; b < ANNEALING_N_PROPOSALS ; b++) proposals[b] = random_int(random_state, p->n);
+    evaluate_flips(s, proposals, ANNEALING_N_PROPOSALS, p, n_violated, delta);
+    int j = proposals[0];
+    int best_delta = 0;
+    for (int b = 0 ; b < ANNEALING_N_PROPOSALS ; b++) {
+      if ((n_violated[b] == 0) && (delta[b] > best_delta)) {
+        j = proposals[b];
+        best_delta = delta[b];
+      }
+    }
+    if (s->sol[j] == 0) flip_item(s, j, undo, p);
+  }
+  // Repair solution if not feasible
+  repair_solution(r, s, undo, p);
+}
 
-  // Generate initial solution with Toyoda algorithm
-  solution *best_solution = toyoda_algorithm(p);
+solution *simulated_annealing(const problem const *p,
+                              float max_time,
+                              intensification *policy,
+                              const sa_config *config,
+                              elite_pool *elite,
+                              search_context *ctx) {
+  mkp_timer_t timer = create_search_timer(ctx, max_time);
 
-  // Allocate memory for storing solution at step t and
-  // solution at step t+1
+  // Generate initial solution with Toyoda algorithm, unless a warm start
+  // is given or the search is resumed (current, then best solution)
+  const snapshot *resume = resumed_snapshot(ctx, "sa", 2);
+  solution *best_solution;
+  if (resume != NULL) {
+    best_solution = create_empty_solution(p);
+    load_solution(resume, 1, best_solution, p);
+  } else if (ctx->warm_start != NULL) {
+    best_solution = clone_solution(ctx->warm_start, p);
+  } else {
+    best_solution = toyoda_algorithm(p);
+  }
+
+  // Moves are applied to the current solution in place,
+  // and undone if rejected
   solution *current_solution = clone_solution(best_solution, p);
-  solution *new_solution = clone_solution(best_solution, p);
+  if (resume != NULL) load_solution(resume, 0, current_solution, p);
+  undo_log *undo = create_undo_log(2 * p->n + 2);
+  uint64_t *before = (uint64_t *)malloc(N_WORDS(p->n) * sizeof(uint64_t));
+  ls_workspace *ws = create_ls_workspace(p);
+  repair_engine *repairer = create_repair_engine(p, REPAIR_RANDOM, 0, &ctx->random_state);
+
+  cooling_schedule sch = create_cooling_schedule(config);
+  cooling_schedule *schedule = &sch;
+  if (resume != NULL) {
+    load_schedule(resume, schedule);
+    policy->n_steps = (long long)load_value(resume, "intensify_steps", 0);
+    resume_search(resume, ctx, &timer);
+  } else {
+    calibrate_schedule(schedule, current_solution, undo, repairer, p, max_time,
+                       &ctx->random_state);
+  }
+  report_incumbent(ctx, best_solution->value);
+
+  while (!schedule_frozen(schedule, &timer)) {
+    // Incumbents are exchanged with the other processes between two
+    // levels: a better one found elsewhere becomes the current solution
+    publish_incumbent(ctx->exchange, best_solution);
+    const solution *shared = import_incumbent(ctx->exchange, best_solution->value, p);
+    if (shared != NULL) {
+      copy_solution(shared, current_solution, p);
+      copy_solution(shared, best_solution, p);
+      report_incumbent(ctx, best_solution->value);
+    }
 
-  // Use best parameters.
-  // If a maximum execution time is provided,
-  // the Markov chain length is set dynamically
-  int markov_chain_length = (max_time <= 0) ? p->n : INT_MAX;
-  float t0 = 500;
-  double e = 1e-05;
-  float alpha = 0.95;
+    // Snapshot of the search, taken between two temperature levels
+    snapshot *snap = begin_snapshot(ctx, "sa", &timer, p);
+    if (snap != NULL) {
+      save_solution(snap, current_solution);
+      save_solution(snap, best_solution);
+      save_schedule(snap, schedule);
+      save_value(snap, "intensify_steps", policy->n_steps);
+      commit_snapshot(ctx);
+    }
 
-  // Number of iterations of th eoutermost loop required in order
-  // to get a frozen system.
-  int k_star = (int)floor(log(e / t0) / log(alpha));
-  
-  for (float t = t0; (t >= e) && !finished(&timer); t *= alpha) {
-    // (max_time / k_star) is the maximum running time
-    // of current iteration
-    timer_t iter_timer = create_timer(max_time / (double)k_star);
+    // With a fixed schedule, the chain length counts accepted moves
+    // and each level has its own time budget
+    mkp_timer_t iter_timer = create_timer(schedule->level_time);
+    int level_best = best_solution->value;
     int m = 0;
-    while ((m < markov_chain_length) && (!finished(&iter_timer)) && \
+    while ((m < schedule->chain_length) && (!finished(&iter_timer)) && \
         (!finished(&timer))) {
-      copy_solution(current_solution, new_solution, p);
-      int i = rand() % p->n; // Randomly select bit to flip
-      if (new_solution->sol[i] == 0) {
-        // Add item if not present in solution
-        new_solution->sol[i] = 1;
-      } else {
-        // Remove item if present in solution
-        new_solution->sol[i] = 0;
-        new_solution->sol[rand() % p->n] = 1;
-      }
-      // Repair solution if not feasible
-      update_solution(new_solution, p);
-      while (!is_feasible(new_solution, p)) {
-        int j = rand() % p->n; // Randomly select item to remove
-        if (new_solution->sol[j] == 1) {
-          new_solution->sol[j] = 0;
-          update_solution(new_solution, p);
-        }
-      }
+      int current_value = current_solution->value;
+      annealing_move(current_solution, undo, repairer, p, &ctx->random_state);
+      schedule->n_steps++;
 
-      // Improve newly created solution with iterative best-fit
-      // The neighbourhood is of size 1 to avoid slowing down GA
-      improve_with_1_moves(new_solution, p, TOYODA, BI, max_time);
+      // Improve newly created solution with iterative best-fit,
+      // depending on the intensification policy.
+      // Items changed by the local search are added to the undo log.
+      if (should_intensify(policy, current_solution, best_solution->value, &ctx->random_state)) {
+        memcpy(before, current_solution->bits, N_WORDS(p->n) * sizeof(uint64_t));
+        intensify(policy, current_solution, p, TOYODA, ws, &timer, ctx);
+        log_differences(current_solution, before, undo);
+      }
 
       // Randomly decide whether to accept new solution as current solution
-      if (metropolis_criterion(new_solution->value, current_solution->value, t)) {
-        copy_solution(new_solution, current_solution, p);
-        m++;
+      if (metropolis_criterion(current_solution->value, current_value, schedule->t,
+                               &ctx->random_state)) {
+        commit_flips(undo);
+        offer_elite(elite, current_solution, p);
+        if (schedule->mode == FIXED_COOLING) m++;
+      } else {
+        undo_flips(current_solution, undo, p);
       }
+      if (schedule->mode == ADAPTIVE_COOLING) m++;
 
       // Store current solution if higher value of the objective
       if (current_solution->value > best_solution->value) {
         copy_solution(current_solution, best_solution, p);
+        report_incumbent(ctx, best_solution->value);
       }
     }
+    next_temperature(schedule, &timer, max_time, best_solution->value > level_best);
   }
+  destroy_solution(current_solution);
+  destroy_undo_log(undo);
+  free(before);
+  destroy_ls_workspace(ws);
+  destroy_repair_engine(repairer);
   return best_solution;
-}
\ No newline at end of file
+}
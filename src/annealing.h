@@ -26,9 +26,24 @@
 #include "perturbative.h"
 #include "mkpsolution.h"
 #include "mkpneighbourhood.h"
+#include "intensification.h"
+#include "schedule.h"
+#include "checkpoint.h"
+#include "exchange.h"
+#include "batch_eval.h"
+#include "repair.h"
 
 #include <stdint.h>
 
+// Number of insertions proposed after a removal in annealing_move
+#define ANNEALING_N_PROPOSALS 8
+
+
+/*
+ * Default settings of SA: fixed geometric cooling from t0 = 500
+ * with alpha = 0.95, frozen at 1e-5, without reheating.
+ */
+sa_config create_sa_config(void);
 
 /*
  * Metropolis acceptance criterion. Returns 1 if newly created
@@ -37,15 +52,48 @@
  * new_f            : objective value of the newly created solution
  * current_f        : objective value of current solution
  * t                : current temperature of the system
+ * random_state     : state of the random generator
+ */
+int metropolis_criterion(double new_f, double current_f, double t, uint64_t *random_state);
+
+/*
+ * Random move of simulated annealing, applied in place with delta
+ * evaluation. A random item is flipped; if it was removed, the most
+ * profitable feasible insertion among ANNEALING_N_PROPOSALS random items
+ * (batch-evaluated) is applied, or the first of them if none fits.
+ * Random items are then removed by the repair engine until the
+ * solution is feasible again. Every flip is recorded in undo so that
+ * the move can be undone if it is rejected.
+ *
+ * s                : current solution (modified in place)
+ * undo             : undo log where flips are recorded
+ * r                : repair engine (REPAIR_RANDOM without ADD phase
+ *                    in simulated_annealing)
+ * p                : instance of MKP
+ * random_state     : state of the random generator
  */
-int metropolis_criterion(double new_f, double current_f, double t);
+void annealing_move(solution *s, undo_log *undo, repair_engine *r, const problem *p,
+                    uint64_t *random_state);
 
 /*
  * Generate a feasible solution with simulated annealing.
  *
  * p                : instance of MKP
  * max_time         : Maximum execution time
+ * policy           : When to improve new solutions with local search
+ * config           : Settings of SA (cooling schedule)
+ * elite            : Pool where accepted solutions are offered (can be NULL)
+ * ctx              : Context of the solve (random state, incumbents), with
+ *                    the checkpoints of the current and best solutions and
+ *                    of the schedule taken between two temperature levels,
+ *                    the snapshot to resume from, and the warm start used
+ *                    as the initial solution instead of Toyoda's
  */
-solution *simulated_annealing(const problem const *p, float max_time);
+solution *simulated_annealing(const problem const *p,
+                              float max_time,
+                              intensification *policy,
+                              const sa_config *config,
+                              elite_pool *elite,
+                              search_context *ctx);
 
 #endif // __ANNEALING_H__
\ No newline at end of file
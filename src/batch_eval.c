@@ -0,0 +1,112 @@
+/***************************************************************************
+ *   Copyright (C) 2018 Antoine Passemiers                                 *
+ *   apassemi@ulb.ac.be                                                    *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#include "batch_eval.h"
+
+
+/*
+ * Dense kernel, instantiated for 32-bit and 16-bit weights. Weights are
+ * widened to int when compared with the slacks, so the 16-bit version
+ * reads half the memory and fits twice as many weights per vector.
+ */
+#define DEFINE_EVALUATE_DENSE(NAME, WEIGHT_TYPE, WEIGHTS)                   \
+static int NAME(const solution *s, const int *items, int n_items,          \
+                const problem *p, int *n_violated, int *delta) {           \
+  const int m = p->m;                                                       \
+  const int *restrict used = s->resources_used;                             \
+  const int *restrict capacities = p->capacities;                           \
+  int n_feasible = 0;                                                       \
+  int b = 0;                                                                \
+  /* Blocks of four candidates share the loads of used and capacities */   \
+  for (; b + 4 <= n_items ; b += 4) {                                       \
+    const WEIGHT_TYPE *restrict w0 = p->WEIGHTS + (size_t)items[b] * m;     \
+    const WEIGHT_TYPE *restrict w1 = p->WEIGHTS + (size_t)items[b + 1] * m; \
+    const WEIGHT_TYPE *restrict w2 = p->WEIGHTS + (size_t)items[b + 2] * m; \
+    const WEIGHT_TYPE *restrict w3 = p->WEIGHTS + (size_t)items[b + 3] * m; \
+    /* +1 for an insertion, -1 for a removal */                             \
+    int s0 = 1 - 2 * s->sol[items[b]];                                      \
+    int s1 = 1 - 2 * s->sol[items[b + 1]];                                  \
+    int s2 = 1 - 2 * s->sol[items[b + 2]];                                  \
+    int s3 = 1 - 2 * s->sol[items[b + 3]];                                  \
+    int v0 = 0, v1 = 0, v2 = 0, v3 = 0;                                     \
+    for (int i = 0 ; i < m ; i++) {                                         \
+      int slack = capacities[i] - used[i];                                  \
+      v0 += (s0 * w0[i] > slack);                                           \
+      v1 += (s1 * w1[i] > slack);                                           \
+      v2 += (s2 * w2[i] > slack);                                           \
+      v3 += (s3 * w3[i] > slack);                                           \
+    }                                                                       \
+    n_violated[b] = v0;                                                     \
+    n_violated[b + 1] = v1;                                                 \
+    n_violated[b + 2] = v2;                                                 \
+    n_violated[b + 3] = v3;                                                 \
+    delta[b] = s0 * p->profits[items[b]];                                   \
+    delta[b + 1] = s1 * p->profits[items[b + 1]];                           \
+    delta[b + 2] = s2 * p->profits[items[b + 2]];                           \
+    delta[b + 3] = s3 * p->profits[items[b + 3]];                           \
+    n_feasible += (v0 == 0) + (v1 == 0) + (v2 == 0) + (v3 == 0);            \
+  }                                                                         \
+  /* Remaining candidates */                                                \
+  for (; b < n_items ; b++) {                                               \
+    const WEIGHT_TYPE *restrict w = p->WEIGHTS + (size_t)items[b] * m;      \
+    int sign = 1 - 2 * s->sol[items[b]];                                    \
+    int v = 0;                                                              \
+    for (int i = 0 ; i < m ; i++) {                                         \
+      v += (sign * w[i] > capacities[i] - used[i]);                         \
+    }                                                                       \
+    n_violated[b] = v;                                                      \
+    delta[b] = sign * p->profits[items[b]];                                 \
+    n_feasible += (v == 0);                                                 \
+  }                                                                         \
+  return(n_feasible);                                                       \
+}
+
+DEFINE_EVALUATE_DENSE(evaluate_flips_32, int, weights)
+DEFINE_EVALUATE_DENSE(evaluate_flips_16, int16_t, weights16)
+
+// Sparse kernel: only the knapsacks of each item can be violated
+static int evaluate_flips_sparse(const solution *s, const int *items, int n_items,
+                                 const problem *p, int *n_violated, int *delta) {
+  int n_feasible = 0;
+  for (int b = 0 ; b < n_items ; b++) {
+    int item = items[b];
+    int sign = 1 - 2 * s->sol[item];
+    int v = 0;
+    for (int k = p->nz_start[item] ; k < p->nz_start[item + 1] ; k++) {
+      int i = p->nz_rows[k];
+      v += (sign * p->nz_weights[k] > p->capacities[i] - s->resources_used[i]);
+    }
+    n_violated[b] = v;
+    delta[b] = sign * p->profits[item];
+    n_feasible += (v == 0);
+  }
+  return(n_feasible);
+}
+
+int evaluate_flips(const solution *s,
+                   const int *items,
+                   int n_items,
+                   const problem *p,
+                   int *n_violated,
+                   int *delta) {
+  if (p->sparse) return(evaluate_flips_sparse(s, items, n_items, p, n_violated, delta));
+  if (p->weights16 != NULL) return(evaluate_flips_16(s, items, n_items, p, n_violated, delta));
+  return(evaluate_flips_32(s, items, n_items, p, n_violated, delta));
+}
@@ -0,0 +1,54 @@
+/***************************************************************************
+ *   Copyright (C) 2018 Antoine Passemiers                                 *
+ *   apassemi@ulb.ac.be                                                    *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#ifndef __BATCH_EVAL_H__
+#define __BATCH_EVAL_H__
+
+#include "mkpsolution.h"
+#include "mkpneighbourhood.h"
+
+
+/*
+ * Evaluate the flips of a block of candidate items against the current
+ * solution in one pass over their item-major weight columns. Candidates
+ * are processed four at a time, so that each capacity and resource
+ * usage is loaded once for four columns, and the loops over the
+ * constraints are branch-free so that the compiler can vectorize them
+ * (see 'make vectorized'). On sparse instances, each candidate only
+ * reads its nonzero weights, so constraints that s already violates
+ * are not counted. Returns the number of feasible flips.
+ *
+ * s                : current solution (not modified)
+ * items            : candidate items, flipped in or out depending on s
+ * n_items          : number of candidates
+ * p                : instance of MKP
+ * n_violated       : output vector of length n_items containing the number
+ *                    of constraints violated after each flip (0 if feasible)
+ * delta            : output vector of length n_items containing the change
+ *                    of objective caused by each flip
+ */
+int evaluate_flips(const solution *s,
+                   const int *items,
+                   int n_items,
+                   const problem *p,
+                   int *n_violated,
+                   int *delta);
+
+#endif // __BATCH_EVAL_H__
@@ -0,0 +1,227 @@
+/***************************************************************************
+ *   Copyright (C) 2018 Antoine Passemiers                                 *
+ *   apassemi@ulb.ac.be                                                    *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+/*
+ * Micro-benchmarks of the search operators.
+ *
+ * Usage: mkpbench <path_to_instance> [<path_to_instance> ...]
+ *          [--moves value] [--seed value]
+ *
+ * Files may be OR-Library collections, whose instances are then
+ * benchmarked one by one.
+ */
+
+#include "mkpdata.h"
+#include "utils.h"
+#include "mkpsolution.h"
+#include "mkpproblem.h"
+#include "instance_stream.h"
+#include "mkpneighbourhood.h"
+#include "constructive.h"
+#include "annealing.h"
+#include "repair.h"
+
+// Temperature at which moves are accepted or rejected
+#define BENCH_TEMPERATURE 100.0
+
+// Number of random items added to make a solution infeasible
+#define BENCH_OVERFILL 4
+
+
+// SA move as implemented before delta evaluation: the solution is copied,
+// bits are flipped by hand and everything is recomputed after each change
+void legacy_annealing_move(const solution *current, solution *new_solution, const problem *p) {
+  copy_solution(current, new_solution, p);
+  int i = rand() % p->n;
+  if (new_solution->sol[i] == 0) {
+    new_solution->sol[i] = 1;
+  } else {
+    new_solution->sol[i] = 0;
+    new_solution->sol[rand() % p->n] = 1;
+  }
+  update_solution(new_solution, p);
+  while (!is_feasible(new_solution, p)) {
+    int j = rand() % p->n;
+    if (new_solution->sol[j] == 1) {
+      new_solution->sol[j] = 0;
+      update_solution(new_solution, p);
+    }
+  }
+}
+
+double bench_legacy_annealing(const solution *initial, const problem *p, int n_moves,
+                              int seed) {
+  srand(seed);
+  uint64_t random_state = seed_random_state(seed);
+  solution *current = clone_solution(initial, p);
+  solution *new_solution = clone_solution(initial, p);
+  mkp_timer_t timer = create_timer(0);
+  for (int k = 0 ; k < n_moves ; k++) {
+    legacy_annealing_move(current, new_solution, p);
+    if (metropolis_criterion(new_solution->value, current->value, BENCH_TEMPERATURE,
+                             &random_state)) {
+      copy_solution(new_solution, current, p);
+    }
+  }
+  double rate = n_moves / elapsed_time(&timer);
+  destroy_solution(current);
+  destroy_solution(new_solution);
+  return(rate);
+}
+
+double bench_delta_annealing(const solution *initial, const problem *p, int n_moves,
+                             int seed) {
+  uint64_t random_state = seed_random_state(seed);
+  solution *current = clone_solution(initial, p);
+  undo_log *undo = create_undo_log(2 * p->n + 2);
+  repair_engine *r = create_repair_engine(p, REPAIR_RANDOM, 0, &random_state);
+  mkp_timer_t timer = create_timer(0);
+  for (int k = 0 ; k < n_moves ; k++) {
+    int current_value = current->value;
+    annealing_move(current, undo, r, p, &random_state);
+    if (metropolis_criterion(current->value, current_value, BENCH_TEMPERATURE, &random_state)) {
+      commit_flips(undo);
+    } else {
+      undo_flips(current, undo, p);
+    }
+  }
+  double rate = n_moves / elapsed_time(&timer);
+  destroy_solution(current);
+  destroy_undo_log(undo);
+  destroy_repair_engine(r);
+  return(rate);
+}
+
+// GA repair as implemented before the repair engine: pseudo-utilities
+// are sorted, and all constraints are rescanned for every selected item
+void legacy_repair(solution *s, int *indices, float *u, float *v,
+                   float *pseudo_utilities, const problem *p) {
+  compute_pseudo_utilities(u, v, pseudo_utilities, s, p);
+  indexes_of_sorted_array(indices, pseudo_utilities, p->n);
+  for (int j = s->n - 1; j > -1; j--) {
+    int item = indices[j];
+    if (s->sol[item]) {
+      for (int i = 0; i < s->m; i++) {
+        if (s->resources_used[i] > p->capacities[i]) {
+          remove_item(s, item, p);
+          break;
+        }
+      }
+    }
+  }
+  for (int j = 0; j < s->n; j++) check_and_add_item(s, indices[j], p);
+}
+
+// Repairs per second of solutions made infeasible by adding
+// BENCH_OVERFILL random items to a feasible one, as GA children are
+double bench_repair(const solution *initial, const problem *p, int n_repairs,
+                    int legacy, enum repair_order order_mode, int seed) {
+  srand(seed);
+  uint64_t random_state = seed_random_state(seed);
+  solution *s = clone_solution(initial, p);
+  int *indices = create_shuffled(p->n, &random_state);
+  float *u = (float *)malloc(p->m * sizeof(float));
+  float *v = (float *)malloc(p->n * sizeof(float));
+  float *pseudo_utilities = (float *)malloc(p->n * sizeof(float));
+  repair_engine *r = create_repair_engine(p, order_mode, 1, NULL);
+  mkp_timer_t timer = create_timer(0);
+  for (int k = 0 ; k < n_repairs ; k++) {
+    copy_solution(initial, s, p);
+    for (int j = 0 ; j < BENCH_OVERFILL ; j++) add_item(s, rand() % p->n, p);
+    if (legacy) {
+      if (!is_feasible(s, p)) legacy_repair(s, indices, u, v, pseudo_utilities, p);
+    } else {
+      repair_solution(r, s, NULL, p);
+    }
+  }
+  double rate = n_repairs / elapsed_time(&timer);
+  destroy_solution(s);
+  destroy_repair_engine(r);
+  free(indices);
+  free(u);
+  free(v);
+  free(pseudo_utilities);
+  return(rate);
+}
+
+// Name of the last instance read from a file, with its index in collections
+static void instance_name(char *name, size_t size, const char *filename,
+                          const instance_stream *stream) {
+  if (stream->n_instances > 1) snprintf(name, size, "%s#%d", filename, stream->index);
+  else snprintf(name, size, "%s", filename);
+}
+
+int main(int argc, char *argv[]) {
+  int n_moves = 100000;
+  int seed = 0;
+  int n_instances = 0;
+  char **instances = (char **)malloc(argc * sizeof(char *));
+  for (int i = 1 ; i < argc ; i++) {
+    if ((strcmp(argv[i], "--moves") == 0) && (i + 1 < argc)) n_moves = atoi(argv[++i]);
+    else if ((strcmp(argv[i], "--seed") == 0) && (i + 1 < argc)) seed = atoi(argv[++i]);
+    else instances[n_instances++] = argv[i];
+  }
+  if (n_instances == 0) {
+    printf("Usage: mkpbench <path_to_instance> [<path_to_instance> ...] \
+[--moves value] [--seed value]\n");
+    free(instances);
+    return(1);
+  }
+
+  printf("%-40s %16s %16s %8s\n", "instance", "legacy moves/s", "delta moves/s", "speedup");
+  char name[256];
+  for (int k = 0 ; k < n_instances ; k++) {
+    instance_stream *stream = open_instance_stream(instances[k]);
+    problem *p;
+    while ((p = next_instance(stream)) != NULL) {
+      solution *initial = toyoda_algorithm(p);
+
+      double legacy = bench_legacy_annealing(initial, p, n_moves, seed);
+      double delta = bench_delta_annealing(initial, p, n_moves, seed);
+      instance_name(name, sizeof(name), instances[k], stream);
+      printf("%-40s %16.0f %16.0f %7.1fx\n", name, legacy, delta, delta / legacy);
+
+      destroy_solution(initial);
+    }
+    close_instance_stream(stream);
+  }
+
+  printf("\n%-40s %16s %16s %16s\n", "instance", "legacy repairs/s",
+         "dynamic repairs/s", "static repairs/s");
+  for (int k = 0 ; k < n_instances ; k++) {
+    instance_stream *stream = open_instance_stream(instances[k]);
+    problem *p;
+    while ((p = next_instance(stream)) != NULL) {
+      solution *initial = toyoda_algorithm(p);
+      int n_repairs = n_moves / 10 + 1;
+
+      double legacy = bench_repair(initial, p, n_repairs, 1, REPAIR_DYNAMIC, seed);
+      double dynamic = bench_repair(initial, p, n_repairs, 0, REPAIR_DYNAMIC, seed);
+      double fixed = bench_repair(initial, p, n_repairs, 0, REPAIR_STATIC, seed);
+      instance_name(name, sizeof(name), instances[k], stream);
+      printf("%-40s %16.0f %16.0f %16.0f\n", name, legacy, dynamic, fixed);
+
+      destroy_solution(initial);
+    }
+    close_instance_stream(stream);
+  }
+  free(instances);
+  return(0);
+}
@@ -0,0 +1,385 @@
+/***************************************************************************
+ *   Copyright (C) 2018 Antoine Passemiers                                 *
+ *   apassemi@ulb.ac.be                                                    *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#include <sched.h>
+
+#include "branch_and_bound.h"
+
+// Number of multiplier updates performed at the root
+#define BB_SURROGATE_ITERATIONS 100
+
+// The timer is polled once every BB_TIMER_PERIOD expanded nodes
+#define BB_TIMER_PERIOD 64
+
+
+static bb_node *bb_alloc_node(bb_worker *w) {
+  bb_shared *sh = w->shared;
+  bb_node *node = w->free_list;
+  if (node != NULL) {
+    w->free_list = node->next;
+  } else {
+    // Node, resources and decisions are stored in a single block
+    node = (bb_node *)malloc(sizeof(bb_node) + sh->m * sizeof(int) + sh->n);
+    node->resources_used = (int *)(node + 1);
+    node->x = (char *)(node->resources_used + sh->m);
+  }
+  return(node);
+}
+
+static void bb_release_node(bb_worker *w, bb_node *node) {
+  node->next = w->free_list;
+  w->free_list = node;
+}
+
+static void bb_heap_swap(bb_node **nodes, int a, int b) {
+  bb_node *tmp = nodes[a];
+  nodes[a] = nodes[b];
+  nodes[b] = tmp;
+}
+
+static bb_node *bb_heap_pop(bb_pool *pool) {
+  bb_node **h = pool->nodes;
+  bb_node *top = h[0];
+  h[0] = h[--pool->size];
+  int i = 0;
+  while (1) {
+    int l = 2 * i + 1, r = l + 1, largest = i;
+    if ((l < pool->size) && (h[l]->bound > h[largest]->bound)) largest = l;
+    if ((r < pool->size) && (h[r]->bound > h[largest]->bound)) largest = r;
+    if (largest == i) break;
+    bb_heap_swap(h, i, largest);
+    i = largest;
+  }
+  return(top);
+}
+
+static void bb_pool_push(bb_pool *pool, bb_node *node, enum bb_strategy strategy) {
+  pthread_mutex_lock(&pool->lock);
+  if (pool->size == pool->capacity) {
+    // Grow the buffer and unroll the ring so that head is back to 0
+    int capacity = 2 * pool->capacity;
+    bb_node **nodes = (bb_node **)malloc(capacity * sizeof(bb_node *));
+    for (int i = 0 ; i < pool->size ; i++) {
+      nodes[i] = pool->nodes[(pool->head + i) % pool->capacity];
+    }
+    free(pool->nodes);
+    pool->nodes = nodes;
+    pool->capacity = capacity;
+    pool->head = 0;
+  }
+  if (strategy == DEPTH_FIRST) {
+    pool->nodes[(pool->head + pool->size) % pool->capacity] = node;
+    pool->size++;
+  } else {
+    // Sift up in the max-heap
+    int i = pool->size++;
+    pool->nodes[i] = node;
+    while ((i > 0) && (pool->nodes[(i - 1) / 2]->bound < pool->nodes[i]->bound)) {
+      bb_heap_swap(pool->nodes, i, (i - 1) / 2);
+      i = (i - 1) / 2;
+    }
+  }
+  pthread_mutex_unlock(&pool->lock);
+}
+
+static bb_node *bb_pool_pop(bb_pool *pool, enum bb_strategy strategy, int steal) {
+  bb_node *node = NULL;
+  pthread_mutex_lock(&pool->lock);
+  if (pool->size > 0) {
+    if (strategy == BEST_FIRST) {
+      node = bb_heap_pop(pool);
+    } else if (steal) {
+      // Thieves take the shallowest node, i.e. the largest subtree
+      node = pool->nodes[pool->head];
+      pool->head = (pool->head + 1) % pool->capacity;
+      pool->size--;
+    } else {
+      node = pool->nodes[(pool->head + pool->size - 1) % pool->capacity];
+      pool->size--;
+    }
+  }
+  pthread_mutex_unlock(&pool->lock);
+  return(node);
+}
+
+int bb_bound(const bb_shared *sh, int depth, int value, const int *resources_used) {
+  int m = sh->m;
+  double capacity = 0.0;
+  for (int i = 0 ; i < m ; i++) {
+    capacity += sh->multipliers[i] * (sh->capacities[i] - resources_used[i]);
+  }
+  double bound = value;
+  for (int k = depth ; k < sh->n ; k++) {
+    // An item that does not fit now will never fit deeper in the subtree
+    const int *w = sh->weights + (size_t)k * m;
+    int fits = 1;
+    for (int i = 0 ; i < m ; i++) {
+      if (resources_used[i] + w[i] > sh->capacities[i]) {
+        fits = 0;
+        break;
+      }
+    }
+    if (!fits) continue;
+    if (sh->s_weights[k] <= capacity) {
+      capacity -= sh->s_weights[k];
+      bound += sh->profits[k];
+    } else {
+      bound += sh->profits[k] * capacity / sh->s_weights[k];
+      break;
+    }
+  }
+  // Profits are integers: the fractional part can be dropped
+  return((int)floor(bound + 1e-6));
+}
+
+static void bb_update_incumbent(bb_shared *sh, const bb_node *node) {
+  int current = __atomic_load_n(&sh->incumbent, __ATOMIC_ACQUIRE);
+  while (node->value > current) {
+    if (__atomic_compare_exchange_n(&sh->incumbent, &current, node->value, 0,
+        __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+      pthread_mutex_lock(&sh->incumbent_lock);
+      // Another thread may have stored a better solution in the meantime
+      if (node->value > sh->incumbent_x_value) {
+        sh->incumbent_x_value = node->value;
+        memset(sh->incumbent_x, 0x00, sh->n);
+        for (int k = 0 ; k < node->depth ; k++) {
+          if (node->x[k]) sh->incumbent_x[sh->order[k]] = 1;
+        }
+        report_incumbent(sh->ctx, node->value);
+      }
+      pthread_mutex_unlock(&sh->incumbent_lock);
+      break;
+    }
+  }
+}
+
+static void bb_expand(bb_worker *w, bb_node *node) {
+  bb_shared *sh = w->shared;
+  int m = sh->m;
+  int d = node->depth;
+  int incumbent = __atomic_load_n(&sh->incumbent, __ATOMIC_ACQUIRE);
+
+  if ((node->bound <= incumbent) || (d == sh->n)) {
+    bb_release_node(w, node);
+    __atomic_sub_fetch(&sh->pending, 1, __ATOMIC_ACQ_REL);
+    return;
+  }
+
+  // Child where the item at depth d is selected (if it fits)
+  bb_node *child = NULL;
+  const int *weights = sh->weights + (size_t)d * m;
+  int fits = 1;
+  for (int i = 0 ; i < m ; i++) {
+    if (node->resources_used[i] + weights[i] > sh->capacities[i]) {
+      fits = 0;
+      break;
+    }
+  }
+  if (fits) {
+    child = bb_alloc_node(w);
+    child->depth = d + 1;
+    child->value = node->value + sh->profits[d];
+    memcpy(child->x, node->x, d);
+    child->x[d] = 1;
+    for (int i = 0 ; i < m ; i++) {
+      child->resources_used[i] = node->resources_used[i] + weights[i];
+    }
+    // Every node is a feasible solution
+    bb_update_incumbent(sh, child);
+    child->bound = bb_bound(sh, child->depth, child->value, child->resources_used);
+    incumbent = __atomic_load_n(&sh->incumbent, __ATOMIC_ACQUIRE);
+    if (child->bound <= incumbent) {
+      bb_release_node(w, child);
+      child = NULL;
+    }
+  }
+
+  // The parent node is recycled as the child where the item is discarded
+  node->x[d] = 0;
+  node->depth = d + 1;
+  node->bound = bb_bound(sh, node->depth, node->value, node->resources_used);
+  if (node->bound <= incumbent) {
+    bb_release_node(w, node);
+    node = NULL;
+  }
+
+  // The selected child is pushed last so that depth-first search
+  // dives along the branching order.
+  int n_pushed = 0;
+  if (node != NULL) {
+    bb_pool_push(&w->pool, node, sh->strategy);
+    n_pushed++;
+  }
+  if (child != NULL) {
+    bb_pool_push(&w->pool, child, sh->strategy);
+    n_pushed++;
+  }
+  if (n_pushed != 1) {
+    __atomic_add_fetch(&sh->pending, n_pushed - 1, __ATOMIC_ACQ_REL);
+  }
+}
+
+static void *bb_worker_run(void *arg) {
+  bb_worker *w = (bb_worker *)arg;
+  bb_shared *sh = w->shared;
+
+  while (!__atomic_load_n(&sh->stop, __ATOMIC_ACQUIRE)) {
+    bb_node *node = bb_pool_pop(&w->pool, sh->strategy, 0);
+    // Steal work from the other workers when the local pool is empty
+    for (int v = 1 ; (node == NULL) && (v < sh->n_threads) ; v++) {
+      bb_worker *victim = &sh->workers[(w->id + v) % sh->n_threads];
+      node = bb_pool_pop(&victim->pool, sh->strategy, 1);
+    }
+    if (node == NULL) {
+      // Search is over once no node is open or being expanded
+      if (__atomic_load_n(&sh->pending, __ATOMIC_ACQUIRE) == 0) break;
+      sched_yield();
+      continue;
+    }
+    if (((w->n_nodes % BB_TIMER_PERIOD) == 0) && finished(&sh->timer)) {
+      __atomic_store_n(&sh->stop, 1, __ATOMIC_RELEASE);
+      bb_pool_push(&w->pool, node, sh->strategy);
+      break;
+    }
+    w->n_nodes++;
+    bb_expand(w, node);
+  }
+  return(NULL);
+}
+
+solution *branch_and_bound(const problem *p,
+                           const solution *initial_solution,
+                           enum bb_strategy strategy,
+                           int n_threads,
+                           float max_time,
+                           bb_stats *stats,
+                           search_context *ctx) {
+  int n = p->n, m = p->m;
+  if (n_threads < 1) n_threads = 1;
+
+  surrogate *sr = create_surrogate(p, BB_SURROGATE_ITERATIONS);
+
+  // Reorder instance data by position in the branching order
+  bb_shared sh;
+  sh.n = n;
+  sh.m = m;
+  sh.order = sr->order;
+  sh.multipliers = sr->multipliers;
+  sh.capacities = p->capacities;
+  sh.profits = (int *)malloc(n * sizeof(int));
+  sh.weights = (int *)malloc((size_t)n * m * sizeof(int));
+  sh.s_weights = (double *)malloc(n * sizeof(double));
+  for (int k = 0 ; k < n ; k++) {
+    int j = sr->order[k];
+    sh.profits[k] = p->profits[j];
+    sh.s_weights[k] = sr->weights[j];
+    for (int i = 0 ; i < m ; i++) sh.weights[(size_t)k * m + i] = p->constraints[i][j];
+  }
+  sh.strategy = strategy;
+  sh.n_threads = n_threads;
+  sh.incumbent_x = (char *)calloc(n, 1);
+  sh.incumbent = 0;
+  sh.incumbent_x_value = 0;
+  sh.ctx = ctx;
+  if ((initial_solution != NULL) && is_feasible(initial_solution, p)) {
+    sh.incumbent = initial_solution->value;
+    sh.incumbent_x_value = initial_solution->value;
+    for (int j = 0 ; j < n ; j++) sh.incumbent_x[j] = (char)initial_solution->sol[j];
+  }
+  pthread_mutex_init(&sh.incumbent_lock, NULL);
+  sh.stop = 0;
+  sh.timer = create_search_timer(ctx, max_time);
+
+  sh.workers = (bb_worker *)malloc(n_threads * sizeof(bb_worker));
+  for (int t = 0 ; t < n_threads ; t++) {
+    bb_worker *w = &sh.workers[t];
+    w->id = t;
+    w->shared = &sh;
+    w->free_list = NULL;
+    w->n_nodes = 0;
+    w->pool.capacity = 2 * n + 2;
+    w->pool.nodes = (bb_node **)malloc(w->pool.capacity * sizeof(bb_node *));
+    w->pool.head = 0;
+    w->pool.size = 0;
+    pthread_mutex_init(&w->pool.lock, NULL);
+  }
+
+  // Root node: nothing fixed
+  bb_node *root = bb_alloc_node(&sh.workers[0]);
+  root->depth = 0;
+  root->value = 0;
+  memset(root->resources_used, 0x00, m * sizeof(int));
+  root->bound = bb_bound(&sh, 0, 0, root->resources_used);
+  bb_pool_push(&sh.workers[0].pool, root, strategy);
+  sh.pending = 1;
+
+  for (int t = 1 ; t < n_threads ; t++) {
+    pthread_create(&sh.workers[t].thread, NULL, bb_worker_run, &sh.workers[t]);
+  }
+  bb_worker_run(&sh.workers[0]);
+  for (int t = 1 ; t < n_threads ; t++) {
+    pthread_join(sh.workers[t].thread, NULL);
+  }
+
+  // The best bound of the remaining open nodes bounds the optimum
+  int upper_bound = sh.incumbent;
+  long long n_nodes = 0;
+  for (int t = 0 ; t < n_threads ; t++) {
+    bb_worker *w = &sh.workers[t];
+    n_nodes += w->n_nodes;
+    for (int i = 0 ; i < w->pool.size ; i++) {
+      bb_node *node = w->pool.nodes[(w->pool.head + i) % w->pool.capacity];
+      if (node->bound > upper_bound) upper_bound = node->bound;
+      free(node);
+    }
+    while (w->free_list != NULL) {
+      bb_node *node = w->free_list;
+      w->free_list = node->next;
+      free(node);
+    }
+    free(w->pool.nodes);
+    pthread_mutex_destroy(&w->pool.lock);
+  }
+
+  solution *s = create_empty_solution(p);
+  for (int j = 0 ; j < n ; j++) {
+    if (sh.incumbent_x[j]) add_item(s, j, p);
+  }
+
+  if (stats != NULL) {
+    stats->n_nodes = n_nodes;
+    stats->elapsed = elapsed_time(&sh.timer);
+    stats->nodes_per_second = (stats->elapsed > 0) ? (n_nodes / stats->elapsed) : 0.0;
+    stats->lower_bound = s->value;
+    stats->upper_bound = upper_bound;
+    stats->gap = (upper_bound > 0) ? \
+      (100.0 * (upper_bound - s->value) / (double)upper_bound) : 0.0;
+    stats->optimal = (sh.pending == 0);
+  }
+
+  pthread_mutex_destroy(&sh.incumbent_lock);
+  free(sh.workers);
+  free(sh.incumbent_x);
+  free(sh.profits);
+  free(sh.weights);
+  free(sh.s_weights);
+  destroy_surrogate(sr);
+  return(s);
+}
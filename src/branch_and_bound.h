@@ -0,0 +1,207 @@
+/***************************************************************************
+ *   Copyright (C) 2018 Antoine Passemiers                                 *
+ *   apassemi@ulb.ac.be                                                    *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#ifndef __BRANCH_AND_BOUND_H__
+#define __BRANCH_AND_BOUND_H__
+
+#include <pthread.h>
+
+#include "mkpalgotypes.h"
+#include "mkpsolution.h"
+#include "mkpneighbourhood.h"
+#include "surrogate.h"
+#include "context.h"
+
+/*
+ * Statistics reported by the branch-and-bound algorithm.
+ *
+ * n_nodes          : number of nodes of the search tree that have been expanded
+ * elapsed          : running time of the search, in seconds
+ * nodes_per_second : n_nodes / elapsed
+ * lower_bound      : value of the best solution found (incumbent)
+ * upper_bound      : best proven upper bound on the optimal value
+ * gap              : relative gap between both bounds, in percent
+ * optimal          : whether the search tree has been fully explored,
+ *                   in which case the incumbent is optimal
+ */
+typedef struct _bb_stats {
+  long long n_nodes;
+  double elapsed;
+  double nodes_per_second;
+  int lower_bound;
+  int upper_bound;
+  double gap;
+  int optimal;
+} bb_stats;
+
+/*
+ * Node of the search tree. Items are branched on in the order
+ * given by the surrogate relaxation, so that a node at depth d has
+ * fixed the first d items of this order. Undecided items are
+ * considered as not selected, hence each node is a feasible solution.
+ *
+ * depth          : number of items that have been fixed
+ * value          : objective value of the fixed items
+ * bound          : upper bound on the value of the subtree
+ * resources_used : vector of length m, resources used by the fixed items
+ * x              : vector of length n, x[k] tells whether the k-th item
+ *                  of the branching order is selected
+ * next           : next node in the free list of a worker
+ */
+typedef struct _bb_node {
+  int depth;
+  int value;
+  int bound;
+  int *resources_used;
+  char *x;
+  struct _bb_node *next;
+} bb_node;
+
+/*
+ * Set of open nodes owned by a worker. With DEPTH_FIRST, nodes are stored
+ * in a ring buffer used as a stack by its owner, while thieves take the
+ * oldest (shallowest) node. With BEST_FIRST, nodes are stored in a
+ * binary max-heap on their bounds.
+ *
+ * nodes          : array of pointers to open nodes
+ * head           : position of the oldest node (ring buffer only)
+ * size           : number of open nodes
+ * capacity       : allocated length of nodes
+ * lock           : protects the pool against concurrent steals
+ */
+typedef struct _bb_pool {
+  bb_node **nodes;
+  int head;
+  int size;
+  int capacity;
+  pthread_mutex_t lock;
+} bb_pool;
+
+struct _bb_shared;
+
+/*
+ * Search thread of the branch-and-bound algorithm.
+ *
+ * id             : identifier of the worker
+ * pool           : open nodes owned by the worker
+ * free_list      : recycled nodes
+ * n_nodes        : number of nodes expanded by the worker
+ * shared         : data shared by all workers
+ * thread         : underlying POSIX thread
+ */
+typedef struct _bb_worker {
+  int id;
+  bb_pool pool;
+  bb_node *free_list;
+  long long n_nodes;
+  struct _bb_shared *shared;
+  pthread_t thread;
+} bb_worker;
+
+/*
+ * Data shared by all workers. Instance data is reordered by
+ * position in the branching order so that the bounding procedure
+ * walks memory contiguously.
+ *
+ * n, m           : number of items and knapsacks
+ * order          : order[k] is the item branched on at depth k
+ * profits        : profits[k] is the profit of item order[k]
+ * weights        : position-major weight matrix, the weights of item
+ *                  order[k] are weights[k*m], ..., weights[k*m+m-1]
+ * capacities     : knapsack capacities
+ * multipliers    : surrogate multipliers
+ * s_weights      : s_weights[k] is the surrogate weight of item order[k]
+ * strategy       : node selection strategy
+ * n_threads      : number of workers
+ * workers        : array of n_threads workers
+ * incumbent      : value of the best solution found (atomic)
+ * incumbent_x    : selected items of the best solution found
+ * incumbent_x_value : value of the solution stored in incumbent_x
+ * incumbent_lock : protects incumbent_x
+ * ctx            : context where new incumbents are reported (top-level
+ *                  searches only, NULL for the subproblems of kernel search)
+ * pending        : number of open or in-process nodes (atomic)
+ * stop           : set to 1 when the time limit has been reached (atomic)
+ * timer          : global timer
+ */
+typedef struct _bb_shared {
+  int n;
+  int m;
+  int *order;
+  int *profits;
+  int *weights;
+  int *capacities;
+  double *multipliers;
+  double *s_weights;
+  enum bb_strategy strategy;
+  int n_threads;
+  bb_worker *workers;
+  int incumbent;
+  char *incumbent_x;
+  int incumbent_x_value;
+  pthread_mutex_t incumbent_lock;
+  search_context *ctx;
+  long long pending;
+  int stop;
+  mkp_timer_t timer;
+} bb_shared;
+
+/*
+ * Compute an upper bound on the best completion of a partial solution,
+ * by solving the LP relaxation of the surrogate knapsack restricted to
+ * the undecided items that still fit in every knapsack.
+ *
+ * sh             : data shared by the workers
+ * depth          : number of fixed items
+ * value          : objective value of the fixed items
+ * resources_used : resources used by the fixed items
+ */
+int bb_bound(const bb_shared *sh, int depth, int value, const int *resources_used);
+
+/*
+ * Solve a MKP instance exactly with a parallel branch-and-bound
+ * algorithm. Subtrees are explored by a pool of work-stealing threads
+ * that share the value of the incumbent solution. Nodes are bounded
+ * with the surrogate relaxation of the problem.
+ * If the time limit is reached before the search tree has been fully
+ * explored, the best solution found is returned and the remaining gap
+ * is reported in stats.
+ *
+ * p                : instance of MKP
+ * initial_solution : feasible solution used as first incumbent
+ *                    (can be NULL)
+ * strategy         : DEPTH_FIRST (with diving) or BEST_FIRST
+ * n_threads        : number of search threads
+ * max_time         : maximum execution time. If max_time <= 0,
+ *                    then the search runs until optimality is proven.
+ * stats            : where to store statistics about the search
+ *                    (can be NULL)
+ * ctx              : context where new incumbents are reported
+ *                    (can be NULL)
+ */
+solution *branch_and_bound(const problem *p,
+                           const solution *initial_solution,
+                           enum bb_strategy strategy,
+                           int n_threads,
+                           float max_time,
+                           bb_stats *stats,
+                           search_context *ctx);
+
+#endif // __BRANCH_AND_BOUND_H__
@@ -0,0 +1,446 @@
+/***************************************************************************
+ *   Copyright (C) 2018 Antoine Passemiers                                 *
+ *   apassemi@ulb.ac.be                                                    *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#include "checkpoint.h"
+#include "output.h"
+
+#include <ctype.h>
+
+
+static snapshot *create_snapshot(void) {
+  snapshot *s = (snapshot *)malloc(sizeof(snapshot));
+  memset(s, 0x00, sizeof(snapshot));
+  return(s);
+}
+
+void destroy_snapshot(snapshot *s) {
+  free(s->order);
+  free(s->bits);
+  free(s);
+}
+
+// Write a snapshot to a file, returns whether it succeeded
+static int write_snapshot(const snapshot *s, FILE *file) {
+  output_writer *w = create_output_writer(file);
+  write_format(w, "mkp-checkpoint 1\nphase %s\ninstance %d\nn %d\n", s->phase, s->instance, s->n);
+  write_format(w, "elapsed %.17g\nrandom_state %llu\n", s->elapsed,
+    (unsigned long long)s->random_state);
+  for (int k = 0 ; k < s->n_values ; k++) {
+    write_format(w, "value %s %.17g\n", s->names[k], s->values[k]);
+  }
+  if (s->n_order > 0) {
+    write_string(w, "order");
+    for (int k = 0 ; k < s->n_order ; k++) {
+      write_bytes(w, " ", 1);
+      write_int(w, s->order[k]);
+    }
+    write_bytes(w, "\n", 1);
+  }
+  for (int k = 0 ; k < s->n_solutions ; k++) {
+    write_string(w, "solution ");
+    write_bits_hex(w, s->bits + (size_t)k * N_WORDS(s->n), s->n);
+    write_bytes(w, "\n", 1);
+  }
+  write_string(w, "end\n");
+  destroy_output_writer(w);
+  return(!ferror(file));
+}
+
+// Write the snapshot to a temporary file, then replace the checkpoint
+// file with it: a reader never sees a partially written snapshot
+static int store_snapshot(const snapshot *s, const char *path) {
+  size_t length = strlen(path);
+  char *tmp_path = (char *)malloc(length + 5);
+  memcpy(tmp_path, path, length);
+  memcpy(tmp_path + length, ".tmp", 5);
+  FILE *file = fopen(tmp_path, "w");
+  int success = (file != NULL);
+  if (success) {
+    success = write_snapshot(s, file);
+    success = (fclose(file) == 0) && success;
+    success = success && (rename(tmp_path, path) == 0);
+  }
+  free(tmp_path);
+  return(success);
+}
+
+static void *checkpoint_writer_run(void *arg) {
+  checkpointer *cp = (checkpointer *)arg;
+  pthread_mutex_lock(&cp->lock);
+  while (1) {
+    while (!cp->has_pending && !cp->stop) pthread_cond_wait(&cp->wakeup, &cp->lock);
+    if (!cp->has_pending) break;
+    // Take the pending snapshot, so that the search can fill the other
+    // one while this one is written
+    snapshot *s = cp->pending;
+    cp->pending = cp->writing;
+    cp->writing = s;
+    cp->has_pending = 0;
+    pthread_mutex_unlock(&cp->lock);
+    int success = store_snapshot(s, cp->path);
+    pthread_mutex_lock(&cp->lock);
+    if (!success) cp->error = 1;
+  }
+  pthread_mutex_unlock(&cp->lock);
+  return(NULL);
+}
+
+checkpointer *create_checkpointer(const char *path, float interval) {
+  checkpointer *cp = (checkpointer *)malloc(sizeof(checkpointer));
+  cp->path = path;
+  cp->interval = interval;
+  cp->last_capture = wall_time();
+  cp->instance = 1;
+  cp->pending = create_snapshot();
+  cp->writing = create_snapshot();
+  cp->has_pending = 0;
+  cp->stop = 0;
+  cp->error = 0;
+  pthread_mutex_init(&cp->lock, NULL);
+  pthread_cond_init(&cp->wakeup, NULL);
+  pthread_create(&cp->thread, NULL, checkpoint_writer_run, cp);
+  return(cp);
+}
+
+void start_checkpoint_instance(checkpointer *cp, int index) {
+  if (cp == NULL) return;
+  cp->instance = index;
+  cp->last_capture = wall_time();
+}
+
+snapshot *begin_snapshot(const search_context *ctx,
+                         const char *phase,
+                         const mkp_timer_t *timer,
+                         const problem *p) {
+  checkpointer *cp = ctx->checkpoint;
+  if (cp == NULL) return(NULL);
+  double now = wall_time();
+  if (now - cp->last_capture < cp->interval) return(NULL);
+  cp->last_capture = now;
+
+  // The lock is only held by the writer while swapping the snapshots
+  pthread_mutex_lock(&cp->lock);
+  snapshot *s = cp->pending;
+  snprintf(s->phase, CHECKPOINT_NAME_LENGTH, "%s", phase);
+  s->instance = cp->instance;
+  s->n = p->n;
+  s->elapsed = elapsed_time(timer);
+  s->random_state = ctx->random_state;
+  s->n_values = 0;
+  s->n_order = 0;
+  s->n_solutions = 0;
+  return(s);
+}
+
+void save_value(snapshot *s, const char *name, double value) {
+  if (s->n_values == CHECKPOINT_MAX_VALUES) return;
+  snprintf(s->names[s->n_values], CHECKPOINT_NAME_LENGTH, "%s", name);
+  s->values[s->n_values++] = value;
+}
+
+void save_order(snapshot *s, const int *order, int n) {
+  if (n > s->order_capacity) {
+    s->order = (int *)realloc(s->order, n * sizeof(int));
+    s->order_capacity = n;
+  }
+  memcpy(s->order, order, n * sizeof(int));
+  s->n_order = n;
+}
+
+void save_solution(snapshot *s, const solution *sol) {
+  size_t n_words = N_WORDS(s->n);
+  if (s->n_solutions == s->capacity) {
+    s->capacity = (s->capacity == 0) ? 4 : (2 * s->capacity);
+    s->bits = (uint64_t *)realloc(s->bits, s->capacity * n_words * sizeof(uint64_t));
+  }
+  memcpy(s->bits + s->n_solutions * n_words, sol->bits, n_words * sizeof(uint64_t));
+  s->n_solutions++;
+}
+
+void commit_snapshot(const search_context *ctx) {
+  checkpointer *cp = ctx->checkpoint;
+  cp->has_pending = 1;
+  pthread_cond_signal(&cp->wakeup);
+  pthread_mutex_unlock(&cp->lock);
+}
+
+int destroy_checkpointer(checkpointer *cp) {
+  pthread_mutex_lock(&cp->lock);
+  cp->stop = 1;
+  pthread_cond_signal(&cp->wakeup);
+  pthread_mutex_unlock(&cp->lock);
+  pthread_join(cp->thread, NULL);
+  int success = !cp->error;
+  pthread_mutex_destroy(&cp->lock);
+  pthread_cond_destroy(&cp->wakeup);
+  destroy_snapshot(cp->pending);
+  destroy_snapshot(cp->writing);
+  free(cp);
+  return(success);
+}
+
+static int hex_digit(int c) {
+  if ((c >= '0') && (c <= '9')) return(c - '0');
+  if ((c >= 'a') && (c <= 'f')) return(c - 'a' + 10);
+  if ((c >= 'A') && (c <= 'F')) return(c - 'A' + 10);
+  return(-1);
+}
+
+static int base64_digit(int c) {
+  if ((c >= 'A') && (c <= 'Z')) return(c - 'A');
+  if ((c >= 'a') && (c <= 'z')) return(c - 'a' + 26);
+  if ((c >= '0') && (c <= '9')) return(c - '0' + 52);
+  if (c == '+') return(62);
+  if (c == '/') return(63);
+  return(-1);
+}
+
+// Set byte k of a bit vector, returns 0 if it holds items beyond n
+static int set_byte(uint64_t *bits, int k, int byte, int n) {
+  if ((k == n / 8) && (byte >> (n % 8))) return(0);
+  bits[k / 8] |= (uint64_t)byte << (8 * (k % 8));
+  return(1);
+}
+
+// Decode the hexadecimal code of a bit vector of n items (as
+// write_bits_hex), returns whether code is such a code
+static int decode_hex(const char *code, size_t length, int n, uint64_t *bits) {
+  int n_bytes = (n + 7) / 8;
+  if (length != 2 * (size_t)n_bytes) return(0);
+  memset(bits, 0x00, N_WORDS(n) * sizeof(uint64_t));
+  for (int k = 0 ; k < n_bytes ; k++) {
+    int high = hex_digit(code[2 * k]), low = hex_digit(code[2 * k + 1]);
+    if ((high < 0) || (low < 0) || !set_byte(bits, k, 16 * high + low, n)) return(0);
+  }
+  return(1);
+}
+
+// Decode the base64 code of a bit vector of n items (as
+// write_solution_base64), returns whether code is such a code
+static int decode_base64(const char *code, size_t length, int n, uint64_t *bits) {
+  int n_bytes = (n + 7) / 8;
+  if (length != 4 * (size_t)((n_bytes + 2) / 3)) return(0);
+  memset(bits, 0x00, N_WORDS(n) * sizeof(uint64_t));
+  for (int k = 0 ; k < n_bytes ; k += 3) {
+    // Groups of 4 characters give 3 bytes, padding excepted
+    int count = (n_bytes - k < 3) ? (n_bytes - k) : 3;
+    uint32_t group = 0;
+    for (int c = 0 ; c < 4 ; c++) {
+      int digit = (c <= count) ? base64_digit(code[4 * (k / 3) + c]) : 0;
+      if ((digit < 0) || ((c > count) && (code[4 * (k / 3) + c] != '='))) return(0);
+      group = (group << 6) | (uint32_t)digit;
+    }
+    for (int b = 0 ; b < count ; b++) {
+      if (!set_byte(bits, k + b, (group >> (16 - 8 * b)) & 0xFF, n)) return(0);
+    }
+  }
+  return(1);
+}
+
+snapshot *read_snapshot(const char *path) {
+  FILE *file = fopen(path, "r");
+  if (file == NULL) return(NULL);
+  int version;
+  if ((fscanf(file, "mkp-checkpoint %d", &version) != 1) || (version != 1)) {
+    fclose(file);
+    return(NULL);
+  }
+
+  snapshot *s = create_snapshot();
+  char key[CHECKPOINT_NAME_LENGTH], name[CHECKPOINT_NAME_LENGTH];
+  char *code = NULL;
+  int complete = 0, valid = 1;
+  while (valid && !complete && (fscanf(file, "%23s", key) == 1)) {
+    if (strcmp(key, "phase") == 0) {
+      valid = (fscanf(file, "%23s", s->phase) == 1);
+    } else if (strcmp(key, "instance") == 0) {
+      valid = (fscanf(file, "%d", &s->instance) == 1);
+    } else if (strcmp(key, "n") == 0) {
+      valid = (fscanf(file, "%d", &s->n) == 1) && (s->n > 0) && (s->n_solutions == 0);
+      code = (char *)realloc(code, 2 * ((s->n + 7) / 8) + 2);
+    } else if (strcmp(key, "elapsed") == 0) {
+      valid = (fscanf(file, "%lf", &s->elapsed) == 1);
+    } else if (strcmp(key, "random_state") == 0) {
+      unsigned long long state;
+      valid = (fscanf(file, "%llu", &state) == 1);
+      s->random_state = (uint64_t)state;
+    } else if (strcmp(key, "value") == 0) {
+      double value;
+      valid = (fscanf(file, "%23s %lf", name, &value) == 2);
+      if (valid) save_value(s, name, value);
+    } else if (strcmp(key, "order") == 0) {
+      // The vector spans the rest of the line
+      int c, x;
+      while (valid && ((c = getc(file)) != '\n') && (c != EOF)) {
+        if (isspace(c)) continue;
+        ungetc(c, file);
+        valid = (fscanf(file, "%d", &x) == 1);
+        if (s->n_order == s->order_capacity) {
+          s->order_capacity = (s->order_capacity == 0) ? 16 : (2 * s->order_capacity);
+          s->order = (int *)realloc(s->order, s->order_capacity * sizeof(int));
+        }
+        s->order[s->n_order++] = x;
+      }
+    } else if (strcmp(key, "solution") == 0) {
+      // Solutions are decoded once the number of items is known
+      valid = (s->n > 0);
+      if (valid) {
+        char format[16];
+        solution decoded;
+        decoded.n = s->n;
+        decoded.bits = (uint64_t *)malloc(N_WORDS(s->n) * sizeof(uint64_t));
+        snprintf(format, sizeof(format), "%%%ds", 2 * ((s->n + 7) / 8) + 1);
+        valid = (fscanf(file, format, code) == 1) && decode_hex(code, strlen(code), s->n, decoded.bits);
+        if (valid) save_solution(s, &decoded);
+        free(decoded.bits);
+      }
+    } else if (strcmp(key, "end") == 0) {
+      complete = 1;
+    } else {
+      valid = 0;
+    }
+  }
+  free(code);
+  fclose(file);
+  if (!complete) {
+    destroy_snapshot(s);
+    return(NULL);
+  }
+  return(s);
+}
+
+const snapshot *resumed_snapshot(const search_context *ctx, const char *phase, int min_solutions) {
+  const snapshot *s = ctx->resume;
+  if ((s == NULL) || (strcmp(s->phase, phase) != 0)) return(NULL);
+  if (s->n_solutions < min_solutions) return(NULL);
+  return(s);
+}
+
+void resume_search(const snapshot *s, search_context *ctx, mkp_timer_t *timer) {
+  ctx->random_state = s->random_state;
+  timer->start -= s->elapsed;
+}
+
+double load_value(const snapshot *s, const char *name, double default_value) {
+  for (int k = 0 ; k < s->n_values ; k++) {
+    if (strcmp(s->names[k], name) == 0) return(s->values[k]);
+  }
+  return(default_value);
+}
+
+void load_solution(const snapshot *s, int k, solution *sol, const problem *p) {
+  const uint64_t *bits = s->bits + (size_t)k * N_WORDS(s->n);
+  for (int j = 0 ; j < p->n ; j++) sol->sol[j] = (int)((bits[j / 64] >> (j % 64)) & 1);
+  update_solution(sol, p);
+}
+
+// Read a whole file into a string, NULL if it cannot be read
+static char *read_text(const char *path) {
+  FILE *file = fopen(path, "r");
+  if (file == NULL) return(NULL);
+  size_t size = 0, capacity = 4096;
+  char *text = (char *)malloc(capacity);
+  size_t n_read;
+  while ((n_read = fread(text + size, 1, capacity - size - 1, file)) > 0) {
+    size += n_read;
+    if (size + 1 == capacity) {
+      capacity *= 2;
+      text = (char *)realloc(text, capacity);
+    }
+  }
+  fclose(file);
+  text[size] = '\0';
+  return(text);
+}
+
+// Parse item indices up to the end of text or the first ']',
+// returns whether only valid indices were found
+static int parse_items(const char *text, solution *s, const problem *p) {
+  memset(s->sol, 0x00, p->n * sizeof(int));
+  while ((*text != '\0') && (*text != ']')) {
+    if (isspace((unsigned char)*text) || (*text == '[') || (*text == ',')) {
+      text++;
+      continue;
+    }
+    char *end;
+    long item = strtol(text, &end, 10);
+    if ((end == text) || (item < 0) || (item >= p->n)) return(0);
+    s->sol[item] = 1;
+    text = end;
+  }
+  update_solution(s, p);
+  return(1);
+}
+
+// Decode a hexadecimal or base64 code of a solution
+static int parse_code(const char *code, size_t length, solution *s, const problem *p) {
+  if (!decode_hex(code, length, p->n, s->bits) && !decode_base64(code, length, p->n, s->bits)) {
+    return(0);
+  }
+  for (int j = 0 ; j < p->n ; j++) s->sol[j] = (int)((s->bits[j / 64] >> (j % 64)) & 1);
+  update_solution(s, p);
+  return(1);
+}
+
+// Length of the token starting at text
+static size_t token_length(const char *text) {
+  size_t length = 0;
+  while ((text[length] != '\0') && (text[length] != '"') && !isspace((unsigned char)text[length])) {
+    length++;
+  }
+  return(length);
+}
+
+solution *read_solution_file(const char *path, const problem *p) {
+  char *text = read_text(path);
+  if (text == NULL) return(NULL);
+  solution *s = create_empty_solution(p);
+  int found = 0;
+  char *start;
+  if ((start = strstr(text, "\"solution\":\"")) != NULL) {
+    // JSON report
+    start += strlen("\"solution\":\"");
+    found = parse_code(start, token_length(start), s, p);
+  } else if ((start = strstr(text, "Solution: ")) != NULL) {
+    // Text report with --format hex or base64
+    start += strlen("Solution: ");
+    found = parse_code(start, token_length(start), s, p);
+  } else if ((start = strstr(text, "Items in solution:")) != NULL) {
+    // Text report
+    found = parse_items(start + strlen("Items in solution:"), s, p);
+  } else if (strstr(text, "No items selected") != NULL) {
+    found = parse_items("", s, p);
+  } else if (strstr(text, "Solution value") == NULL) {
+    // Bare code or list of items
+    start = text;
+    while (isspace((unsigned char)*start)) start++;
+    size_t length = token_length(start);
+    const char *rest = start + length;
+    while (isspace((unsigned char)*rest)) rest++;
+    found = (*start != '\0') && \
+      (((*rest == '\0') && parse_code(start, length, s, p)) || parse_items(start, s, p));
+  }
+  free(text);
+  if (!found) {
+    destroy_solution(s);
+    return(NULL);
+  }
+  return(s);
+}
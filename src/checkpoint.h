@@ -0,0 +1,237 @@
+/***************************************************************************
+ *   Copyright (C) 2018 Antoine Passemiers                                 *
+ *   apassemi@ulb.ac.be                                                    *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#ifndef __CHECKPOINT_H__
+#define __CHECKPOINT_H__
+
+#include <pthread.h>
+
+#include "mkpsolution.h"
+#include "utils.h"
+#include "context.h"
+
+// Maximum number of named values in a snapshot
+#define CHECKPOINT_MAX_VALUES 16
+
+// Maximum length of a phase or value name, including the terminating '\0'
+#define CHECKPOINT_NAME_LENGTH 24
+
+// Interval between two snapshots, in seconds, unless --checkpoint-interval
+#define CHECKPOINT_DEFAULT_INTERVAL 60.0
+
+/*
+ * State of a search at some point of its execution, enough to continue
+ * it from there: the solutions it maintains (e.g. the population of GA,
+ * the current and best solutions of SA), named scalars (e.g. generation
+ * counter, temperature), an integer vector (e.g. the heap of the GA
+ * population), the random state of the solve and the time already spent.
+ * In a file, a snapshot is stored as text:
+ *
+ *   mkp-checkpoint 1
+ *   phase ga
+ *   instance 1
+ *   n 500
+ *   elapsed 12.5
+ *   random_state 12345678901234567
+ *   value generation 73125
+ *   order 5 0 12 ...
+ *   solution 2a8f...         (hexadecimal, as --format hex)
+ *   end
+ *
+ * phase          : search that produced the snapshot ("ga", "sa", "vnd")
+ * instance       : index of the instance in its file (starting at 1)
+ * n              : number of items
+ * elapsed        : seconds spent by the search so far
+ * random_state   : random state of the solve
+ * n_values       : number of named values
+ * names, values  : named values
+ * n_order        : length of the integer vector
+ * order          : integer vector
+ * n_solutions    : number of solutions
+ * bits           : bit vectors of the solutions, N_WORDS(n) words each
+ * capacity       : number of solutions bits can hold
+ * order_capacity : length order can hold
+ */
+typedef struct _snapshot {
+  char phase[CHECKPOINT_NAME_LENGTH];
+  int instance;
+  int n;
+  double elapsed;
+  uint64_t random_state;
+  int n_values;
+  char names[CHECKPOINT_MAX_VALUES][CHECKPOINT_NAME_LENGTH];
+  double values[CHECKPOINT_MAX_VALUES];
+  int n_order;
+  int *order;
+  int n_solutions;
+  uint64_t *bits;
+  int capacity;
+  int order_capacity;
+} snapshot;
+
+/*
+ * Periodic writer of snapshots. The search fills the pending snapshot,
+ * which only costs copying its state in memory, and a background thread
+ * writes it to a temporary file renamed over the checkpoint file, so
+ * that the search never waits for the disk and the file is always
+ * complete. Two snapshots are swapped between the search and the writer.
+ *
+ * path           : checkpoint file
+ * interval       : minimum number of seconds between two snapshots
+ * last_capture   : wall time of the last snapshot
+ * instance       : index of the instance being solved
+ * pending        : snapshot filled by the search
+ * writing        : snapshot being written by the background thread
+ * has_pending    : whether pending holds a snapshot not yet written
+ * stop           : whether the background thread must terminate
+ * error          : whether a snapshot could not be written
+ * lock           : protects the fields shared with the background thread
+ * wakeup         : signals a new pending snapshot or termination
+ * thread         : background thread
+ */
+typedef struct _checkpointer {
+  const char *path;
+  float interval;
+  double last_capture;
+  int instance;
+  snapshot *pending;
+  snapshot *writing;
+  int has_pending;
+  int stop;
+  int error;
+  pthread_mutex_t lock;
+  pthread_cond_t wakeup;
+  pthread_t thread;
+} checkpointer;
+
+/*
+ * Start the background writer of a checkpoint file.
+ *
+ * path           : checkpoint file (not copied)
+ * interval       : minimum number of seconds between two snapshots
+ */
+checkpointer *create_checkpointer(const char *path, float interval);
+
+/*
+ * Tell the checkpointer that a new instance is being solved.
+ *
+ * cp             : checkpointer (may be NULL)
+ * index          : index of the instance in its file (starting at 1)
+ */
+void start_checkpoint_instance(checkpointer *cp, int index);
+
+/*
+ * Begin a snapshot of a search if one is due, i.e. if the context of
+ * the solve has a checkpointer and the interval has elapsed since the
+ * last snapshot. The header (phase, instance, elapsed time, random
+ * state of the solve) is filled, and the search then saves its state
+ * with save_value, save_order and save_solution before calling
+ * commit_snapshot. Returns NULL if no snapshot is due.
+ *
+ * ctx            : context of the solve
+ * phase          : name of the search
+ * timer          : timer of the search, giving its elapsed time
+ * p              : instance of MKP
+ */
+snapshot *begin_snapshot(const search_context *ctx,
+                         const char *phase,
+                         const mkp_timer_t *timer,
+                         const problem *p);
+
+/*
+ * Save a named value, an integer vector or a solution in a snapshot.
+ */
+void save_value(snapshot *s, const char *name, double value);
+void save_order(snapshot *s, const int *order, int n);
+void save_solution(snapshot *s, const solution *sol);
+
+/*
+ * Hand the snapshot begun by begin_snapshot to the background writer.
+ *
+ * ctx            : context given to begin_snapshot
+ */
+void commit_snapshot(const search_context *ctx);
+
+/*
+ * Write the last pending snapshot, stop the background thread and
+ * deallocate the checkpointer. Returns whether all snapshots
+ * were written.
+ *
+ * cp             : checkpointer to destroy
+ */
+int destroy_checkpointer(checkpointer *cp);
+
+/*
+ * Read a checkpoint file. Returns NULL if the file cannot be read, is
+ * not a checkpoint file or is malformed.
+ *
+ * path           : checkpoint file
+ */
+snapshot *read_snapshot(const char *path);
+
+/*
+ * Return the snapshot to resume a search from, if the context of the
+ * solve holds one taken by that search with at least min_solutions
+ * solutions, NULL otherwise.
+ *
+ * ctx            : context of the solve
+ * phase          : name of the search
+ * min_solutions  : number of solutions the search saves at least
+ */
+const snapshot *resumed_snapshot(const search_context *ctx, const char *phase, int min_solutions);
+
+/*
+ * Continue a search from a snapshot: restore the random state of the
+ * solve and move the start of the timer of the search back by the time
+ * already spent, so that the time budget covers the whole run.
+ *
+ * s              : snapshot of the search
+ * ctx            : context of the solve
+ * timer          : timer of the search
+ */
+void resume_search(const snapshot *s, search_context *ctx, mkp_timer_t *timer);
+
+/*
+ * Read back a named value (default_value if it was not saved),
+ * or solution k of a snapshot, in the order they were saved.
+ */
+double load_value(const snapshot *s, const char *name, double default_value);
+void load_solution(const snapshot *s, int k, solution *sol, const problem *p);
+
+/*
+ * Deallocate a snapshot.
+ *
+ * s              : snapshot to deallocate
+ */
+void destroy_snapshot(snapshot *s);
+
+/*
+ * Read a solution of the given instance from a file, as written by mkp:
+ * the JSON report, the "Solution:" line of --format hex or base64, or
+ * the list of items of the text report. A file holding only a list of
+ * item indices, or only a hexadecimal or base64 code, is accepted too.
+ * Returns NULL if no solution of the instance is found.
+ *
+ * path           : solution file
+ * p              : instance of MKP
+ */
+solution *read_solution_file(const char *path, const problem *p);
+
+#endif // __CHECKPOINT_H__
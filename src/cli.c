@@ -0,0 +1,222 @@
+/***************************************************************************
+ *   Copyright (C) 2018 Antoine Passemiers                                 *
+ *   apassemi@ulb.ac.be                                                    *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#include "cli.h"
+#include "genetic.h"
+#include "checkpoint.h"
+#include "mkpsolver.h"
+
+
+void print_usage(void) {
+  printf("Error. Calls to MKP Solver must be of the form:\n\n \
+    \tmkp <path_to_instance>  <random|greedy|toyoda|sdp|sa|ga|eda|bb> \
+    [--fi|--bi|--vnd|--ks] [--max-time value] [--seed value] [--terse] \
+    [--bb-init <random|greedy|toyoda|sdp|sa|ga|eda>] [--bb-strategy <dfs|bfs>] \
+    [--threads value] [--path-relinking] [--elite-size value] \
+    [--ks-bucket value] [--ks-time value] \
+    [--intensify <always|every|prob|near-best|fi|never>] [--intensify-k value] \
+    [--intensify-prob value] [--intensify-within value] \
+    [--intensify-moves value] [--intensify-time value] \
+    [--sa-schedule <fixed|adaptive>] [--reheat] \
+    [--repair-order <dynamic|static>] [--ga-population value] \
+    [--ga-mutation value] [--ga-tournament value] [--sa-t0 value] \
+    [--sa-alpha value] [--sa-frozen value] [--eda-model <pbil|umda>] \
+    [--eda-population value] [--eda-elites value] [--eda-rate value] \
+    [--format <text|json|hex|base64>] [--progress path] \
+    [--checkpoint path] [--checkpoint-interval value] [--resume path] \
+    [--share]\n");
+}
+
+params *create_parse_error(params *pars) {
+  pars->has_parse_error = 1;
+  return(pars);
+}
+
+params *read_params(int argc, char *argv[]) {
+  params *pars = (params *)malloc(sizeof(params));
+  memset(pars, 0x00, sizeof(params));
+  pars->instance_file = argv[1];
+  pars->options = create_mkp_options();
+  mkp_options *opt = &pars->options;
+  pars->checkpoint_interval = CHECKPOINT_DEFAULT_INTERVAL;
+
+  if (argc < 3) return(create_parse_error(pars));
+  if (strcmp(argv[2], "random") == 0) opt->h = RANDOM;
+  else if (strcmp(argv[2], "greedy") == 0) opt->h = GREEDY;
+  else if (strcmp(argv[2], "toyoda") == 0) opt->h = TOYODA;
+  else if (strcmp(argv[2], "sdp") == 0) opt->h = SDP;
+  else if (strcmp(argv[2], "sa") == 0) opt->h = SA;
+  else if (strcmp(argv[2], "ga") == 0) opt->h = GA;
+  else if (strcmp(argv[2], "eda") == 0) opt->h = EDA;
+  else if (strcmp(argv[2], "bb") == 0) opt->h = BB;
+  else return(create_parse_error(pars));
+
+  for (int i = 3 ; i < argc ; i++) {
+    if (strcmp(argv[i], "--max-time") == 0) {
+      opt->max_time = atof(argv[++i]);
+    } else if (strcmp(argv[i], "--seed") == 0) {
+      pars->seed = atoi(argv[++i]);
+      pars->use_seed = 1;
+    } else if (strcmp(argv[i], "--terse") == 0) {
+      pars->terse = 1;
+    } else if (strcmp(argv[i], "--fi") == 0) {
+      if (opt->use_nm + opt->use_vns + opt->use_ks) return(create_parse_error(pars));
+      opt->use_nm = 1;
+      opt->nm = FI;
+    } else if (strcmp(argv[i], "--bi") == 0) {
+      if (opt->use_nm + opt->use_vns + opt->use_ks) return(create_parse_error(pars));
+      opt->use_nm = 1;
+      opt->nm = BI;
+    } else if (strcmp(argv[i], "--vnd") == 0) {
+      if (opt->use_nm + opt->use_vns + opt->use_ks) return(create_parse_error(pars));
+      opt->use_vns = 1;
+      opt->nm = VND;
+    } else if (strcmp(argv[i], "--ks") == 0) {
+      if (opt->use_nm + opt->use_vns + opt->use_ks) return(create_parse_error(pars));
+      opt->use_ks = 1;
+      opt->nm = KS;
+    } else if ((strcmp(argv[i], "--ks-bucket") == 0) && (i + 1 < argc)) {
+      opt->ks_bucket_size = atoi(argv[++i]);
+      if (opt->ks_bucket_size < 2) return(create_parse_error(pars));
+    } else if ((strcmp(argv[i], "--ks-time") == 0) && (i + 1 < argc)) {
+      opt->ks_time = atof(argv[++i]);
+    } else if ((strcmp(argv[i], "--intensify") == 0) && (i + 1 < argc)) {
+      i++;
+      if (strcmp(argv[i], "always") == 0) opt->intensify.mode = INTENSIFY_ALWAYS;
+      else if (strcmp(argv[i], "every") == 0) opt->intensify.mode = INTENSIFY_EVERY_K;
+      else if (strcmp(argv[i], "prob") == 0) opt->intensify.mode = INTENSIFY_PROBABILISTIC;
+      else if (strcmp(argv[i], "near-best") == 0) opt->intensify.mode = INTENSIFY_NEAR_BEST;
+      else if (strcmp(argv[i], "fi") == 0) opt->intensify.mode = INTENSIFY_FIRST_IMPROVEMENT;
+      else if (strcmp(argv[i], "never") == 0) opt->intensify.mode = INTENSIFY_NEVER;
+      else return(create_parse_error(pars));
+    } else if ((strcmp(argv[i], "--intensify-k") == 0) && (i + 1 < argc)) {
+      opt->intensify.every_k = atoi(argv[++i]);
+      if (opt->intensify.every_k < 1) return(create_parse_error(pars));
+    } else if ((strcmp(argv[i], "--intensify-prob") == 0) && (i + 1 < argc)) {
+      opt->intensify.probability = atof(argv[++i]);
+      if (!((opt->intensify.probability >= 0) && (opt->intensify.probability <= 1))) {
+        return(create_parse_error(pars));
+      }
+    } else if ((strcmp(argv[i], "--intensify-within") == 0) && (i + 1 < argc)) {
+      opt->intensify.within = atof(argv[++i]) / 100.0;
+      if (!(opt->intensify.within >= 0)) return(create_parse_error(pars));
+    } else if ((strcmp(argv[i], "--intensify-moves") == 0) && (i + 1 < argc)) {
+      opt->intensify.max_moves = atoi(argv[++i]);
+    } else if ((strcmp(argv[i], "--intensify-time") == 0) && (i + 1 < argc)) {
+      opt->intensify.max_time = atof(argv[++i]);
+    } else if ((strcmp(argv[i], "--sa-schedule") == 0) && (i + 1 < argc)) {
+      i++;
+      if (strcmp(argv[i], "fixed") == 0) opt->sa.cooling = FIXED_COOLING;
+      else if (strcmp(argv[i], "adaptive") == 0) opt->sa.cooling = ADAPTIVE_COOLING;
+      else return(create_parse_error(pars));
+    } else if (strcmp(argv[i], "--reheat") == 0) {
+      opt->sa.reheat = 1;
+    } else if ((strcmp(argv[i], "--sa-t0") == 0) && (i + 1 < argc)) {
+      opt->sa.t0 = atof(argv[++i]);
+      if (opt->sa.t0 <= 0) return(create_parse_error(pars));
+    } else if ((strcmp(argv[i], "--sa-alpha") == 0) && (i + 1 < argc)) {
+      opt->sa.alpha = atof(argv[++i]);
+      if ((opt->sa.alpha <= 0) || (opt->sa.alpha >= 1)) return(create_parse_error(pars));
+    } else if ((strcmp(argv[i], "--sa-frozen") == 0) && (i + 1 < argc)) {
+      opt->sa.t_frozen = atof(argv[++i]);
+      if (opt->sa.t_frozen <= 0) return(create_parse_error(pars));
+    } else if ((strcmp(argv[i], "--repair-order") == 0) && (i + 1 < argc)) {
+      i++;
+      if (strcmp(argv[i], "dynamic") == 0) opt->ga.repair_order = REPAIR_DYNAMIC;
+      else if (strcmp(argv[i], "static") == 0) opt->ga.repair_order = REPAIR_STATIC;
+      else return(create_parse_error(pars));
+      opt->eda.repair_order = opt->ga.repair_order;
+    } else if ((strcmp(argv[i], "--ga-population") == 0) && (i + 1 < argc)) {
+      opt->ga.population_size = atoi(argv[++i]);
+    } else if ((strcmp(argv[i], "--ga-mutation") == 0) && (i + 1 < argc)) {
+      opt->ga.mutation_rate = atoi(argv[++i]);
+      if ((opt->ga.mutation_rate < 0) || (opt->ga.mutation_rate > MAX_MUTATION_RATE)) {
+        return(create_parse_error(pars));
+      }
+    } else if ((strcmp(argv[i], "--ga-tournament") == 0) && (i + 1 < argc)) {
+      opt->ga.tournament_size = atoi(argv[++i]);
+    } else if ((strcmp(argv[i], "--eda-model") == 0) && (i + 1 < argc)) {
+      i++;
+      if (strcmp(argv[i], "pbil") == 0) opt->eda.model = PBIL;
+      else if (strcmp(argv[i], "umda") == 0) opt->eda.model = UMDA;
+      else return(create_parse_error(pars));
+    } else if ((strcmp(argv[i], "--eda-population") == 0) && (i + 1 < argc)) {
+      opt->eda.population_size = atoi(argv[++i]);
+    } else if ((strcmp(argv[i], "--eda-elites") == 0) && (i + 1 < argc)) {
+      opt->eda.n_elites = atoi(argv[++i]);
+    } else if ((strcmp(argv[i], "--eda-rate") == 0) && (i + 1 < argc)) {
+      opt->eda.learning_rate = atof(argv[++i]);
+      if ((opt->eda.learning_rate <= 0) || (opt->eda.learning_rate > 1)) {
+        return(create_parse_error(pars));
+      }
+    } else if ((strcmp(argv[i], "--bb-init") == 0) && (i + 1 < argc)) {
+      i++;
+      if (strcmp(argv[i], "random") == 0) opt->bb_init = RANDOM;
+      else if (strcmp(argv[i], "greedy") == 0) opt->bb_init = GREEDY;
+      else if (strcmp(argv[i], "toyoda") == 0) opt->bb_init = TOYODA;
+      else if (strcmp(argv[i], "sdp") == 0) opt->bb_init = SDP;
+      else if (strcmp(argv[i], "sa") == 0) opt->bb_init = SA;
+      else if (strcmp(argv[i], "ga") == 0) opt->bb_init = GA;
+      else if (strcmp(argv[i], "eda") == 0) opt->bb_init = EDA;
+      else return(create_parse_error(pars));
+    } else if ((strcmp(argv[i], "--bb-strategy") == 0) && (i + 1 < argc)) {
+      i++;
+      if (strcmp(argv[i], "dfs") == 0) opt->bb_strategy = DEPTH_FIRST;
+      else if (strcmp(argv[i], "bfs") == 0) opt->bb_strategy = BEST_FIRST;
+      else return(create_parse_error(pars));
+    } else if ((strcmp(argv[i], "--threads") == 0) && (i + 1 < argc)) {
+      opt->n_threads = atoi(argv[++i]);
+      if (opt->n_threads < 1) return(create_parse_error(pars));
+    } else if ((strcmp(argv[i], "--format") == 0) && (i + 1 < argc)) {
+      i++;
+      if (strcmp(argv[i], "text") == 0) pars->format = TEXT_OUTPUT;
+      else if (strcmp(argv[i], "json") == 0) pars->format = JSON_OUTPUT;
+      else if (strcmp(argv[i], "hex") == 0) pars->format = HEX_OUTPUT;
+      else if (strcmp(argv[i], "base64") == 0) pars->format = BASE64_OUTPUT;
+      else return(create_parse_error(pars));
+    } else if ((strcmp(argv[i], "--progress") == 0) && (i + 1 < argc)) {
+      pars->progress_file = argv[++i];
+    } else if ((strcmp(argv[i], "--checkpoint") == 0) && (i + 1 < argc)) {
+      pars->checkpoint_file = argv[++i];
+    } else if ((strcmp(argv[i], "--checkpoint-interval") == 0) && (i + 1 < argc)) {
+      pars->checkpoint_interval = atof(argv[++i]);
+      if (pars->checkpoint_interval < 0) return(create_parse_error(pars));
+    } else if ((strcmp(argv[i], "--resume") == 0) && (i + 1 < argc)) {
+      pars->resume_file = argv[++i];
+    } else if (strcmp(argv[i], "--path-relinking") == 0) {
+      opt->use_path_relinking = 1;
+    } else if (strcmp(argv[i], "--share") == 0) {
+      opt->share_incumbents = 1;
+    } else if ((strcmp(argv[i], "--elite-size") == 0) && (i + 1 < argc)) {
+      opt->elite_size = atoi(argv[++i]);
+      if (opt->elite_size < 2) return(create_parse_error(pars));
+    }
+  }
+  // Both tournaments draw distinct members
+  if ((opt->ga.tournament_size < 1) || \
+      (2 * opt->ga.tournament_size > opt->ga.population_size)) {
+    return(create_parse_error(pars));
+  }
+  // The EDA learns from a subset of each generation
+  if ((opt->eda.n_elites < 1) || (opt->eda.n_elites > opt->eda.population_size)) {
+    return(create_parse_error(pars));
+  }
+  return(pars);
+}
@@ -0,0 +1,42 @@
+/***************************************************************************
+ *   Copyright (C) 2018 Antoine Passemiers                                 *
+ *   apassemi@ulb.ac.be                                                    *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#ifndef __CLI_H__
+#define __CLI_H__
+
+#include "mkpdata.h"
+#include "utils.h"
+
+/*
+ * Command line of mkp, also used for the requests of mkpd. This module
+ * is linked with the programs, not with libmkp.a.
+ */
+
+// print error message and show cmd syntax
+void print_usage(void);
+
+// set error flag in pars
+params *create_parse_error(params *pars);
+
+// read command line parameters: TO BE EXTENDED. Nothing is printed:
+// the caller shows the usage when pars->has_parse_error is set
+params *read_params(int argc, char *argv[]);
+
+#endif // __CLI_H__
@@ -53,11 +53,11 @@ float euclidean_norm(const float *vec, int vec_size) {
   return(sqrt(norm));
 }
 
-solution *random_insertion(const problem *p) {
+solution *random_insertion(const problem *p, uint64_t *random_state) {
   // Implementation identical to create_random_solution(const problem *p)
   // from mkpsolution.c
   solution *s = create_empty_solution(p);
-  int *indexes = create_shuffled(p->n);
+  int *indexes = create_shuffled(p->n, random_state);
   for (int i = 0 ; i < p->n ; i++) {
     check_and_add_item(s, indexes[i], p);
   }
@@ -96,10 +96,21 @@ void compute_pseudo_utilities(float *u,
   int *x = s->sol;
 
   // Compute vector U
-  for (int i = 0 ; i < p->m ; i++) {
-    u[i] = 0.0;
+  if (p->sparse) {
+    // Only the nonzero weights of the selected items contribute
+    for (int i = 0 ; i < p->m ; i++) u[i] = 0.0;
     for (int j = 0 ; j < p->n ; j++) {
-      u[i] += ((float)w[i][j] / l[i]) * x[j];
+      if (!x[j]) continue;
+      for (int k = p->nz_start[j] ; k < p->nz_start[j + 1] ; k++) {
+        u[p->nz_rows[k]] += (float)p->nz_weights[k] / l[p->nz_rows[k]];
+      }
+    }
+  } else {
+    for (int i = 0 ; i < p->m ; i++) {
+      u[i] = 0.0;
+      for (int j = 0 ; j < p->n ; j++) {
+        u[i] += ((float)w[i][j] / l[i]) * x[j];
+      }
     }
   }
   // Normalize U
@@ -111,8 +122,14 @@ void compute_pseudo_utilities(float *u,
   // Compute vector V
   for (int j = 0 ; j < p->n ; j++) {
     v[j] = 0;
-    for (int i = 0 ; i < p->m ; i++) {
-      v[j] += ((float)w[i][j] / l[i]) * u[i];
+    if (p->sparse) {
+      for (int k = p->nz_start[j] ; k < p->nz_start[j + 1] ; k++) {
+        v[j] += ((float)p->nz_weights[k] / l[p->nz_rows[k]]) * u[p->nz_rows[k]];
+      }
+    } else {
+      for (int i = 0 ; i < p->m ; i++) {
+        v[j] += ((float)w[i][j] / l[i]) * u[i];
+      }
     }
   }
 
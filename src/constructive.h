@@ -74,8 +74,9 @@ float euclidean_norm(const float *vec, int vec_size);
  * in a random order.
  *
  * p : Instance of MKP to solve
+ * random_state : State of the random generator
  */
-solution *random_insertion(const problem *p);
+solution *random_insertion(const problem *p, uint64_t *random_state);
 
 /*
  * Sort items given in a problem, sort them by profit, and add them in this
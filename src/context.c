@@ -0,0 +1,62 @@
+/***************************************************************************
+ *   Copyright (C) 2018 Antoine Passemiers                                 *
+ *   apassemi@ulb.ac.be                                                    *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#include "context.h"
+
+
+void init_search_context(search_context *ctx, uint64_t random_state) {
+  ctx->random_state = random_state;
+  ctx->on_incumbent = NULL;
+  ctx->user_data = NULL;
+  ctx->start = wall_time();
+  ctx->best_value = INT_MIN;
+  pthread_mutex_init(&ctx->lock, NULL);
+  ctx->checkpoint = NULL;
+  ctx->resume = NULL;
+  ctx->warm_start = NULL;
+  ctx->cancel = NULL;
+  ctx->exchange = NULL;
+}
+
+mkp_timer_t create_search_timer(const search_context *ctx, float max_time) {
+  mkp_timer_t timer = create_timer(max_time);
+  if (ctx != NULL) timer.cancel = ctx->cancel;
+  return(timer);
+}
+
+int is_cancelled(const search_context *ctx) {
+  return((ctx != NULL) && (ctx->cancel != NULL) && *ctx->cancel);
+}
+
+void report_incumbent(search_context *ctx, int value) {
+  if ((ctx == NULL) || (ctx->on_incumbent == NULL)) return;
+  pthread_mutex_lock(&ctx->lock);
+  // The callback is called under the lock, so that values are
+  // received in increasing order
+  if (value > ctx->best_value) {
+    ctx->best_value = value;
+    ctx->on_incumbent(ctx->user_data, value, wall_time() - ctx->start);
+  }
+  pthread_mutex_unlock(&ctx->lock);
+}
+
+void clear_search_context(search_context *ctx) {
+  pthread_mutex_destroy(&ctx->lock);
+}
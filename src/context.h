@@ -0,0 +1,114 @@
+/***************************************************************************
+ *   Copyright (C) 2018 Antoine Passemiers                                 *
+ *   apassemi@ulb.ac.be                                                    *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#ifndef __CONTEXT_H__
+#define __CONTEXT_H__
+
+#include <pthread.h>
+
+#include "mkpsolution.h"
+#include "utils.h"
+
+struct _checkpointer;
+struct _snapshot;
+struct _incumbent_exchange;
+
+/*
+ * Function receiving the incumbents of a solve: each new best value,
+ * with the number of seconds since the start of the solve.
+ */
+typedef void (*incumbent_callback)(void *user_data, int value, double time);
+
+/*
+ * State of one solve, shared by the algorithms it runs. Nothing else is
+ * shared between solves, so that several of them can run concurrently
+ * in one process.
+ *
+ * random_state   : state of the random generator of the solve
+ * on_incumbent   : receives the incumbents of the solve (can be NULL)
+ * user_data      : first argument of on_incumbent
+ * start          : wall time at which the solve started
+ * best_value     : last value reported to on_incumbent
+ * lock           : serializes the threads reporting incumbents
+ * checkpoint     : where to take snapshots of the search (can be NULL)
+ * resume         : snapshot to continue from, used by the search
+ *                  whose phase it names (can be NULL)
+ * warm_start     : solution to start from instead of a constructed one
+ *                  (can be NULL)
+ * cancel         : token stopping the searches of the solve (can be NULL)
+ * exchange       : incumbents shared with other processes (can be NULL)
+ */
+typedef struct _search_context {
+  uint64_t random_state;
+  incumbent_callback on_incumbent;
+  void *user_data;
+  double start;
+  int best_value;
+  pthread_mutex_t lock;
+  struct _checkpointer *checkpoint;
+  const struct _snapshot *resume;
+  const solution *warm_start;
+  const cancel_token *cancel;
+  struct _incumbent_exchange *exchange;
+} search_context;
+
+/*
+ * Initialize the context of a solve starting now, without callback
+ * nor checkpoints.
+ *
+ * ctx            : context to initialize
+ * random_state   : initial state of the random generator (see
+ *                  seed_random_state)
+ */
+void init_search_context(search_context *ctx, uint64_t random_state);
+
+/*
+ * Create the timer of a search of the solve, which is also finished
+ * once the solve is cancelled.
+ *
+ * ctx            : context of the solve (may be NULL: no cancellation)
+ * max_time       : time limit of the search in seconds (none if <= 0)
+ */
+mkp_timer_t create_search_timer(const search_context *ctx, float max_time);
+
+/*
+ * Tell whether the solve has been cancelled.
+ *
+ * ctx            : context of the solve (may be NULL)
+ */
+int is_cancelled(const search_context *ctx);
+
+/*
+ * Report a value reached by the search. Only improvements over the
+ * values already reported are passed to the callback. Thread-safe.
+ *
+ * ctx            : context of the solve (may be NULL: nothing is reported)
+ * value          : objective value of a feasible solution
+ */
+void report_incumbent(search_context *ctx, int value);
+
+/*
+ * Release the resources of a context.
+ *
+ * ctx            : context of a finished solve
+ */
+void clear_search_context(search_context *ctx);
+
+#endif // __CONTEXT_H__
@@ -0,0 +1,206 @@
+/***************************************************************************
+ *   Copyright (C) 2018 Antoine Passemiers                                 *
+ *   apassemi@ulb.ac.be                                                    *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#include "eda.h"
+
+// Generations without time limit, unless the model converges before
+#define EDA_MAX_GENERATIONS 1000
+
+// Initial inclusion probability of the items of a warm start
+#define EDA_WARM_START_PROBABILITY 0.75
+
+
+eda_config create_eda_config(void) {
+  eda_config config;
+  config.model = PBIL;
+  config.population_size = 200;
+  config.n_elites = 20;
+  config.learning_rate = 0.1;
+  config.repair_order = REPAIR_DYNAMIC;
+  return(config);
+}
+
+void sample_from_model(solution *s,
+                       const uint64_t *planes,
+                       uint64_t *random_state,
+                       const problem *p) {
+  for (int w = 0 ; w < N_WORDS(p->n) ; w++) {
+    const uint64_t *t = planes + EDA_PRECISION * w;
+    // Compare 64 random numbers with the 64 thresholds from the most
+    // significant bit down, until every comparison is decided:
+    // less[k] is set once r_k < t_k is known, equal[k] while undecided
+    uint64_t less = 0, equal = ~0ULL;
+    for (int b = EDA_PRECISION - 1 ; (b >= 0) && equal ; b--) {
+      uint64_t r = random_word(random_state);
+      less |= equal & ~r & t[b];
+      equal &= ~(r ^ t[b]);
+    }
+    // Padding items have null thresholds and are never selected
+    uint64_t flips = less ^ s->bits[w];
+    while (flips) {
+      int item = 64 * w + __builtin_ctzll(flips);
+      if (s->sol[item]) remove_item(s, item, p);
+      else add_item(s, item, p);
+      flips &= flips - 1;
+    }
+  }
+}
+
+static void *eda_worker_run(void *arg) {
+  eda_worker *w = (eda_worker *)arg;
+  for (int k = w->start ; k < w->end ; k++) {
+    sample_from_model(w->samples[k], w->planes, &w->random_state, w->p);
+    repair_solution(w->repairer, w->samples[k], NULL, w->p);
+  }
+  return(NULL);
+}
+
+static int cmp_value_decreasing(const void *a, const void *b) {
+  const solution *s1 = *(const solution **)a;
+  const solution *s2 = *(const solution **)b;
+  return(s2->value - s1->value);
+}
+
+// Quantize the probabilities into thresholds, stored as bit planes.
+// Returns 1 if every threshold is at one of its bounds (converged model).
+static int build_planes(uint64_t *planes, const float *probabilities, int n) {
+  int max_threshold = (1 << EDA_PRECISION) - 1;
+  int converged = 1;
+  memset(planes, 0x00, EDA_PRECISION * N_WORDS(n) * sizeof(uint64_t));
+  for (int j = 0 ; j < n ; j++) {
+    // Thresholds are kept away from 0 and 1 so that every item
+    // can still enter or leave the samples
+    int t = (int)(probabilities[j] * (max_threshold + 1) + 0.5);
+    if (t < 1) t = 1;
+    if (t > max_threshold) t = max_threshold;
+    if ((t > 1) && (t < max_threshold)) converged = 0;
+    for (int b = 0 ; b < EDA_PRECISION ; b++) {
+      if ((t >> b) & 1) planes[EDA_PRECISION * (j / 64) + b] |= (1ULL << (j % 64));
+    }
+  }
+  return(converged);
+}
+
+solution *estimation_of_distribution(const problem *p,
+                                     float max_time,
+                                     intensification *policy,
+                                     const eda_config *config,
+                                     int n_threads,
+                                     elite_pool *elite,
+                                     search_context *ctx) {
+  int population_size = config->population_size;
+  int n_elites = config->n_elites;
+  if (n_threads < 1) n_threads = 1;
+  if (n_threads > population_size) n_threads = population_size;
+
+  mkp_timer_t timer = create_search_timer(ctx, max_time);
+
+  // Currently best solution
+  solution *best_solution = create_empty_solution(p);
+
+  // Model: independent inclusion probabilities, uniform at first,
+  // or leaning toward the items of the warm start
+  float *probabilities = (float *)malloc(p->n * sizeof(float));
+  for (int j = 0 ; j < p->n ; j++) probabilities[j] = 0.5;
+  if (ctx->warm_start != NULL) {
+    copy_solution(ctx->warm_start, best_solution, p);
+    for (int j = 0 ; j < p->n ; j++) {
+      probabilities[j] = best_solution->sol[j] ? EDA_WARM_START_PROBABILITY
+                                               : (1 - EDA_WARM_START_PROBABILITY);
+    }
+  }
+  uint64_t *planes = (uint64_t *)malloc(EDA_PRECISION * N_WORDS(p->n) * sizeof(uint64_t));
+  int *counts = (int *)malloc(p->n * sizeof(int));
+
+  solution **samples = (solution **)malloc(population_size * sizeof(solution *));
+  for (int k = 0 ; k < population_size ; k++) samples[k] = create_empty_solution(p);
+  ls_workspace *ws = create_ls_workspace(p);
+
+  // Split the generation evenly between the workers
+  eda_worker *workers = (eda_worker *)malloc(n_threads * sizeof(eda_worker));
+  for (int t = 0 ; t < n_threads ; t++) {
+    eda_worker *w = &workers[t];
+    w->p = p;
+    w->planes = planes;
+    w->samples = samples;
+    w->start = (int)((long long)population_size * t / n_threads);
+    w->end = (int)((long long)population_size * (t + 1) / n_threads);
+    w->repairer = create_repair_engine(p, config->repair_order, 1, NULL);
+    // One generator per worker, seeded from the one of the solve
+    w->random_state = random_word(&ctx->random_state) | 1;
+  }
+
+  int converged = build_planes(planes, probabilities, p->n);
+  int generation = 0;
+  while (!converged && !finished(&timer) && \
+         ((max_time > 0) || (generation < EDA_MAX_GENERATIONS))) {
+    // Sample and repair a generation, worker 0 runs on this thread
+    for (int t = 1 ; t < n_threads ; t++) {
+      pthread_create(&workers[t].thread, NULL, eda_worker_run, &workers[t]);
+    }
+    eda_worker_run(&workers[0]);
+    for (int t = 1 ; t < n_threads ; t++) {
+      pthread_join(workers[t].thread, NULL);
+    }
+
+    // Rank the generation and improve its best individual
+    qsort(samples, population_size, sizeof(solution *), cmp_value_decreasing);
+    if (should_intensify(policy, samples[0], best_solution->value,
+                         &ctx->random_state)) {
+      intensify(policy, samples[0], p, GREEDY, ws, &timer, ctx);
+    }
+    offer_elite(elite, samples[0], p);
+    if (samples[0]->value > best_solution->value) {
+      copy_solution(samples[0], best_solution, p);
+      report_incumbent(ctx, best_solution->value);
+    }
+
+    // Item frequencies among the elites
+    memset(counts, 0x00, p->n * sizeof(int));
+    for (int k = 0 ; k < n_elites ; k++) {
+      const uint64_t *bits = samples[k]->bits;
+      for (int w = 0 ; w < N_WORDS(p->n) ; w++) {
+        for (uint64_t word = bits[w] ; word ; word &= word - 1) {
+          counts[64 * w + __builtin_ctzll(word)]++;
+        }
+      }
+    }
+
+    // Model update
+    float rate = (config->model == PBIL) ? config->learning_rate : 1.0;
+    for (int j = 0 ; j < p->n ; j++) {
+      float frequency = (float)counts[j] / n_elites;
+      probabilities[j] = (1 - rate) * probabilities[j] + rate * frequency;
+    }
+    converged = build_planes(planes, probabilities, p->n);
+    generation++;
+  }
+
+  // Deallocate memory
+  for (int t = 0 ; t < n_threads ; t++) destroy_repair_engine(workers[t].repairer);
+  free(workers);
+  for (int k = 0 ; k < population_size ; k++) destroy_solution(samples[k]);
+  free(samples);
+  destroy_ls_workspace(ws);
+  free(probabilities);
+  free(planes);
+  free(counts);
+  return(best_solution);
+}
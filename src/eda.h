@@ -0,0 +1,116 @@
+/***************************************************************************
+ *   Copyright (C) 2018 Antoine Passemiers                                 *
+ *   apassemi@ulb.ac.be                                                    *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#ifndef __EDA_H__
+#define __EDA_H__
+
+#include <pthread.h>
+
+#include "mkpalgotypes.h"
+#include "mkpsolution.h"
+#include "repair.h"
+#include "intensification.h"
+#include "elite.h"
+#include "checkpoint.h"
+
+#include <stdint.h>
+
+// Resolution of the sampling probabilities (bits per threshold)
+#define EDA_PRECISION 8
+
+/*
+ * Worker of the estimation-of-distribution algorithm. Each worker samples,
+ * repairs and evaluates a contiguous slice of the generation with its own
+ * random state and repair engine.
+ *
+ * p              : instance of MKP
+ * planes         : bit planes of the sampling thresholds, shared by workers
+ *                  (see sample_from_model)
+ * samples        : individuals of the generation
+ * start, end     : slice [start, end) of samples handled by the worker
+ * repairer       : repair engine of the worker
+ * random_state   : state of the xorshift64* generator of the worker
+ * thread         : thread running the worker (unused by worker 0)
+ */
+typedef struct _eda_worker {
+  const problem *p;
+  const uint64_t *planes;
+  solution **samples;
+  int start;
+  int end;
+  repair_engine *repairer;
+  uint64_t random_state;
+  pthread_t thread;
+} eda_worker;
+
+/*
+ * Default settings of the EDA: PBIL with 200 individuals per generation,
+ * 20 elites, learning rate 0.1 and dynamic repair order.
+ */
+eda_config create_eda_config(void);
+
+/*
+ * Replace the items of s by a sample of the probabilistic model.
+ * Item j is selected with probability t_j / 2^EDA_PRECISION, where t_j is
+ * its threshold. Thresholds are stored as bit planes: bit b of the
+ * thresholds of items 64w, ..., 64w+63 is the word planes[EDA_PRECISION*w+b].
+ * The 64 items of a word are sampled together by comparing random bytes
+ * with their thresholds in bit-sliced form, and only the items that
+ * differ from s are flipped.
+ *
+ * s              : solution receiving the sample
+ * planes         : bit planes of the thresholds
+ * random_state   : state of the xorshift64* generator
+ * p              : instance of MKP
+ */
+void sample_from_model(solution *s,
+                       const uint64_t *planes,
+                       uint64_t *random_state,
+                       const problem *p);
+
+/*
+ * Generate a feasible solution with an estimation-of-distribution
+ * algorithm. A vector of item inclusion probabilities is sampled to
+ * produce a generation, each individual is repaired, and the model is
+ * moved toward the item frequencies of the best individuals (elites):
+ * PBIL blends them in with the learning rate, UMDA replaces the model by
+ * them. The best individual of each generation is improved according to
+ * the intensification policy.
+ *
+ * p               : instance of MKP
+ * max_time        : maximum execution time. If max_time <= 0,
+ *                   then time is not used as stopping criterion.
+ * policy          : when to improve the best individual of a generation
+ * config          : settings of the EDA
+ * n_threads       : number of threads sampling and repairing a generation
+ * elite           : pool where new solutions are offered (can be NULL)
+ * ctx             : context of the solve (random state, incumbents), whose
+ *                   warm start becomes the first best solution and biases
+ *                   the initial model toward its items
+ */
+solution *estimation_of_distribution(const problem *p,
+                                     float max_time,
+                                     intensification *policy,
+                                     const eda_config *config,
+                                     int n_threads,
+                                     elite_pool *elite,
+                                     search_context *ctx);
+
+#endif // __EDA_H__
@@ -0,0 +1,85 @@
+/***************************************************************************
+ *   Copyright (C) 2018 Antoine Passemiers                                 *
+ *   apassemi@ulb.ac.be                                                    *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#include "elite.h"
+
+
+elite_pool *create_elite_pool(int capacity, int min_distance) {
+  elite_pool *pool = (elite_pool *)malloc(sizeof(elite_pool));
+  pool->size = 0;
+  pool->capacity = capacity;
+  pool->min_distance = min_distance;
+  pool->members = (solution **)malloc(capacity * sizeof(solution *));
+  pool->worst = 0;
+  return(pool);
+}
+
+static void update_worst_elite(elite_pool *pool) {
+  pool->worst = 0;
+  for (int i = 1 ; i < pool->size ; i++) {
+    if (pool->members[i]->value < pool->members[pool->worst]->value) pool->worst = i;
+  }
+}
+
+int offer_elite(elite_pool *pool, const solution *s, const problem *p) {
+  if (pool == NULL) return(0);
+  int full = (pool->size == pool->capacity);
+  // Cheap rejection before computing any distance
+  if (full && (s->value <= pool->members[pool->worst]->value)) return(0);
+  if (!is_feasible(s, p)) return(0);
+
+  int is_best = 1;
+  int min_distance = INT_MAX;
+  int closest_worse = -1, closest_worse_distance = INT_MAX;
+  for (int i = 0 ; i < pool->size ; i++) {
+    solution *member = pool->members[i];
+    if (are_identical(s, member)) return(0);
+    int distance = hamming_distance(s, member);
+    if (distance < min_distance) min_distance = distance;
+    if (member->value >= s->value) is_best = 0;
+    else if (distance < closest_worse_distance) {
+      closest_worse_distance = distance;
+      closest_worse = i;
+    }
+  }
+  if ((min_distance < pool->min_distance) && !is_best) return(0);
+
+  if (!full) {
+    pool->members[pool->size++] = clone_solution(s, p);
+  } else {
+    copy_solution(s, pool->members[closest_worse], p);
+  }
+  update_worst_elite(pool);
+  return(1);
+}
+
+int get_best_elite(const elite_pool *pool) {
+  int best = 0;
+  for (int i = 1 ; i < pool->size ; i++) {
+    if (pool->members[i]->value > pool->members[best]->value) best = i;
+  }
+  return(best);
+}
+
+void destroy_elite_pool(elite_pool *pool) {
+  for (int i = 0 ; i < pool->size ; i++) destroy_solution(pool->members[i]);
+  free(pool->members);
+  free(pool);
+}
@@ -0,0 +1,85 @@
+/***************************************************************************
+ *   Copyright (C) 2018 Antoine Passemiers                                 *
+ *   apassemi@ulb.ac.be                                                    *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#ifndef __ELITE_H__
+#define __ELITE_H__
+
+#include "mkpsolution.h"
+
+/*
+ * Pool of good and diverse solutions collected during the search.
+ * Diversity is measured by the Hamming distance between solutions.
+ *
+ * size           : number of solutions in the pool
+ * capacity       : maximum number of solutions in the pool
+ * min_distance   : minimum Hamming distance between a new solution
+ *                  and the members of the pool for the new solution to be
+ *                  accepted (unless it is better than all members)
+ * members        : array of pointers to the solutions of the pool
+ * worst          : index of the member with lowest objective value
+ */
+typedef struct _elite_pool {
+  int size;
+  int capacity;
+  int min_distance;
+  solution **members;
+  int worst;
+} elite_pool;
+
+/*
+ * Create an empty elite pool.
+ *
+ * capacity       : maximum number of solutions in the pool
+ * min_distance   : diversity threshold (see elite_pool)
+ */
+elite_pool *create_elite_pool(int capacity, int min_distance);
+
+/*
+ * Offer a solution to the pool, which only holds feasible solutions.
+ * A copy of the solution is inserted if it is feasible, not a duplicate
+ * and either:
+ *   - the pool is not full and the solution is at least min_distance
+ *     items away from every member,
+ *   - the pool is full, the solution is better than the worst member and
+ *     it is either far enough from every member or better than all of them.
+ * In the latter case, the most similar member among those that are worse
+ * than the solution is replaced. Returns 1 if the solution was inserted.
+ *
+ * pool           : elite pool (can be NULL, in which case nothing happens)
+ * s              : candidate solution
+ * p              : instance of MKP
+ */
+int offer_elite(elite_pool *pool, const solution *s, const problem *p);
+
+/*
+ * Return the index of the best member of a non-empty pool.
+ *
+ * pool           : elite pool
+ */
+int get_best_elite(const elite_pool *pool);
+
+/*
+ * Deallocate an elite pool and its members.
+ *
+ * pool           : elite pool to deallocate
+ */
+void destroy_elite_pool(elite_pool *pool);
+
+#endif // __ELITE_H__
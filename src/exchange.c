@@ -0,0 +1,197 @@
+/***************************************************************************
+ *   Copyright (C) 2018 Antoine Passemiers                                 *
+ *   apassemi@ulb.ac.be                                                    *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#include <errno.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "exchange.h"
+
+
+// One step of FNV-1a, on a 32-bit word
+static uint64_t hash_word(uint64_t h, int x) {
+  return((h ^ (uint32_t)x) * 0x100000001B3ULL);
+}
+
+uint64_t instance_hash(const problem *p) {
+  // FNV-1a over the words of the instance, then a final mix
+  uint64_t h = 0xCBF29CE484222325ULL;
+  h = hash_word(h, p->n);
+  h = hash_word(h, p->m);
+  for (int j = 0 ; j < p->n ; j++) h = hash_word(h, p->profits[j]);
+  for (int i = 0 ; i < p->m ; i++) {
+    for (int j = 0 ; j < p->n ; j++) h = hash_word(h, p->constraints[i][j]);
+    h = hash_word(h, p->capacities[i]);
+  }
+  h = (h ^ (h >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  h = (h ^ (h >> 27)) * 0x94D049BB133111EBULL;
+  h ^= h >> 31;
+  // Key 0 marks an unused segment
+  return((h == 0) ? 1 : h);
+}
+
+incumbent_exchange *open_incumbent_exchange(const problem *p) {
+  uint64_t key = instance_hash(p);
+  char name[32];
+  snprintf(name, sizeof(name), "/mkp-%016llx", (unsigned long long)key);
+  size_t size = sizeof(shared_incumbent) + N_WORDS(p->n) * sizeof(uint64_t);
+
+  // The first process creates the segment, filled with zeros.
+  // It is only grown, so that concurrent openings agree on its content.
+  int fd = shm_open(name, O_RDWR | O_CREAT, 0600);
+  if (fd < 0) {
+    fprintf(stderr, "error opening shared memory %s: %s\n", name, strerror(errno));
+    return(NULL);
+  }
+  struct stat st;
+  if ((fstat(fd, &st) != 0) || (((size_t)st.st_size < size) && (ftruncate(fd, size) != 0))) {
+    fprintf(stderr, "error resizing shared memory %s: %s\n", name, strerror(errno));
+    close(fd);
+    return(NULL);
+  }
+  void *address = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (address == MAP_FAILED) {
+    fprintf(stderr, "error mapping shared memory %s: %s\n", name, strerror(errno));
+    return(NULL);
+  }
+
+  incumbent_exchange *ex = (incumbent_exchange *)malloc(sizeof(incumbent_exchange));
+  strcpy(ex->name, name);
+  ex->key = key;
+  ex->n = p->n;
+  ex->size = size;
+  ex->shared = (shared_incumbent *)address;
+  ex->bits = (uint64_t *)malloc(N_WORDS(p->n) * sizeof(uint64_t));
+  ex->imported = create_empty_solution(p);
+  ex->warned = 0;
+  return(ex);
+}
+
+// Take over the lock seq (odd) if its owner has died, for instance killed
+// while publishing, and reset the segment, whose content may be
+// half-written. Returns 1 if the lock was released this way.
+static int recover_stale_lock(shared_incumbent *sh, uint32_t seq) {
+  pid_t owner = (pid_t)__atomic_load_n(&sh->owner, __ATOMIC_RELAXED);
+  if ((owner <= 0) || (kill(owner, 0) == 0) || (errno != ESRCH)) return(0);
+  // seq + 2 is still odd: the lock changes hands without being released
+  if (!__atomic_compare_exchange_n(&sh->seq, &seq, seq + 2, 0,
+                                   __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) return(0);
+  __atomic_store_n(&sh->owner, (int32_t)getpid(), __ATOMIC_RELAXED);
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+  __atomic_store_n(&sh->key, 0, __ATOMIC_RELAXED);
+  __atomic_store_n(&sh->n, 0, __ATOMIC_RELAXED);
+  __atomic_store_n(&sh->value, 0, __ATOMIC_RELAXED);
+  __atomic_store_n(&sh->owner, 0, __ATOMIC_RELAXED);
+  __atomic_store_n(&sh->seq, seq + 3, __ATOMIC_RELEASE);
+  return(1);
+}
+
+int publish_incumbent(incumbent_exchange *ex, const solution *s) {
+  if (ex == NULL) return(0);
+  shared_incumbent *sh = ex->shared;
+  // Most solutions do not improve on the segment: this is checked
+  // without writing to it
+  if ((__atomic_load_n(&sh->key, __ATOMIC_RELAXED) == ex->key) && \
+      (__atomic_load_n(&sh->value, __ATOMIC_RELAXED) >= s->value)) return(0);
+
+  // Take the segment: seq goes from even to odd. A lock left by a dead
+  // writer is recovered once, then the attempts start again.
+  uint32_t seq = 0;
+  int locked = 0;
+  for (int round = 0 ; (round < 2) && !locked ; round++) {
+    for (int attempt = 0 ; (attempt < EXCHANGE_MAX_ATTEMPTS) && !locked ; attempt++) {
+      seq = __atomic_load_n(&sh->seq, __ATOMIC_RELAXED);
+      locked = !(seq & 1) && __atomic_compare_exchange_n(&sh->seq, &seq, seq + 1, 0,
+                                                        __ATOMIC_ACQUIRE, __ATOMIC_RELAXED);
+      if (!locked) sched_yield();
+    }
+    if (!locked && !((seq & 1) && recover_stale_lock(sh, seq))) break;
+  }
+  if (!locked) {
+    if (!__atomic_exchange_n(&ex->warned, 1, __ATOMIC_RELAXED)) {
+      fprintf(stderr, "warning: shared memory %s stays locked, incumbents are not shared\n",
+        ex->name);
+    }
+    return(0);
+  }
+  __atomic_store_n(&sh->owner, (int32_t)getpid(), __ATOMIC_RELAXED);
+  // Readers must not see the new data with the old (even) seq
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+
+  // A segment holding another instance (hash collision) is left as is
+  int published = 0;
+  uint64_t key = __atomic_load_n(&sh->key, __ATOMIC_RELAXED);
+  int unused = (key == 0);
+  if (unused || ((key == ex->key) && (__atomic_load_n(&sh->n, __ATOMIC_RELAXED) == ex->n))) {
+    if (unused || (__atomic_load_n(&sh->value, __ATOMIC_RELAXED) < s->value)) {
+      __atomic_store_n(&sh->key, ex->key, __ATOMIC_RELAXED);
+      __atomic_store_n(&sh->n, ex->n, __ATOMIC_RELAXED);
+      __atomic_store_n(&sh->value, s->value, __ATOMIC_RELAXED);
+      for (int w = 0 ; w < N_WORDS(ex->n) ; w++) {
+        __atomic_store_n(&sh->bits[w], s->bits[w], __ATOMIC_RELAXED);
+      }
+      published = 1;
+    }
+  }
+  __atomic_store_n(&sh->owner, 0, __ATOMIC_RELAXED);
+  __atomic_store_n(&sh->seq, seq + 2, __ATOMIC_RELEASE);
+  return(published);
+}
+
+const solution *import_incumbent(incumbent_exchange *ex, int value, const problem *p) {
+  if (ex == NULL) return(NULL);
+  shared_incumbent *sh = ex->shared;
+  uint32_t seq = __atomic_load_n(&sh->seq, __ATOMIC_ACQUIRE);
+  if (seq & 1) {
+    // Processes that only import also recover a lock left by a dead writer
+    recover_stale_lock(sh, seq);
+    return(NULL);
+  }
+  if ((__atomic_load_n(&sh->key, __ATOMIC_RELAXED) != ex->key) || \
+      (__atomic_load_n(&sh->n, __ATOMIC_RELAXED) != ex->n)) return(NULL);
+  int shared_value = __atomic_load_n(&sh->value, __ATOMIC_RELAXED);
+  if (shared_value <= value) return(NULL);
+
+  // Copy, then check that no writer came in the meantime
+  for (int w = 0 ; w < N_WORDS(ex->n) ; w++) {
+    ex->bits[w] = __atomic_load_n(&sh->bits[w], __ATOMIC_RELAXED);
+  }
+  __atomic_thread_fence(__ATOMIC_ACQUIRE);
+  if (__atomic_load_n(&sh->seq, __ATOMIC_RELAXED) != seq) return(NULL);
+
+  solution *s = ex->imported;
+  for (int j = 0 ; j < p->n ; j++) s->sol[j] = (int)((ex->bits[j / 64] >> (j % 64)) & 1);
+  update_solution(s, p);
+  // The segment is only trusted if it describes a better feasible solution
+  if (!is_feasible(s, p) || (s->value != shared_value)) return(NULL);
+  return(s);
+}
+
+void close_incumbent_exchange(incumbent_exchange *ex) {
+  munmap(ex->shared, ex->size);
+  destroy_solution(ex->imported);
+  free(ex->bits);
+  free(ex);
+}
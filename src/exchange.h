@@ -0,0 +1,126 @@
+/***************************************************************************
+ *   Copyright (C) 2018 Antoine Passemiers                                 *
+ *   apassemi@ulb.ac.be                                                    *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#ifndef __EXCHANGE_H__
+#define __EXCHANGE_H__
+
+#include "mkpproblem.h"
+#include "mkpsolution.h"
+
+// Maximum number of attempts at taking the segment from another writer
+#define EXCHANGE_MAX_ATTEMPTS 64
+
+/*
+ * Incumbent published in a POSIX shared-memory segment, readable by
+ * every process solving the same instance. The segment is named after
+ * a hash of the instance (/mkp-<hash in hex>) and outlives the processes.
+ *
+ * Accesses follow a sequence lock: a writer makes seq odd (with a
+ * compare-and-swap, which also excludes the other writers), records its
+ * pid in owner, writes value and bits, then clears owner and makes seq
+ * even again. Readers copy value and bits without locking and retry
+ * later if seq was odd or has changed. A lock whose owner has died is
+ * taken over, and the segment, which may be half-written, is reset.
+ *
+ * key            : hash of the instance (0 until the first publication)
+ * n              : number of items of the instance
+ * seq            : sequence number, odd while a writer is active
+ * value          : value of the published solution
+ * owner          : pid of the active writer (0 if none, or not yet known)
+ * bits           : the solution, packed as in solution.bits
+ */
+typedef struct _shared_incumbent {
+  uint64_t key;
+  int32_t n;
+  uint32_t seq;
+  int32_t value;
+  int32_t owner;
+  uint64_t bits[];
+} shared_incumbent;
+
+/*
+ * Connection of a process to the segment of an instance.
+ *
+ * name           : name of the segment
+ * key            : hash of the instance
+ * n              : number of items of the instance
+ * size           : size of the mapping in bytes
+ * shared         : mapped segment
+ * bits           : copy of the bits read from the segment
+ * imported       : last solution read from the segment
+ * warned         : whether a locked segment has been reported
+ */
+typedef struct _incumbent_exchange {
+  char name[32];
+  uint64_t key;
+  int n;
+  size_t size;
+  shared_incumbent *shared;
+  uint64_t *bits;
+  solution *imported;
+  int warned;
+} incumbent_exchange;
+
+/*
+ * Hash of an instance: its dimensions, profits, weights and capacities.
+ *
+ * p              : instance of MKP
+ */
+uint64_t instance_hash(const problem *p);
+
+/*
+ * Open (or create) the segment of an instance and map it. Returns NULL,
+ * after printing an error, if shared memory is not available.
+ *
+ * p              : instance of MKP
+ */
+incumbent_exchange *open_incumbent_exchange(const problem *p);
+
+/*
+ * Publish a solution if it is better than the one in the segment.
+ * Returns 1 if it was published. The solution is skipped, with a
+ * warning the first time, when a live writer holds the segment for
+ * too long. Thread-safe.
+ *
+ * ex             : exchange (may be NULL: nothing is published)
+ * s              : feasible solution of the instance
+ */
+int publish_incumbent(incumbent_exchange *ex, const solution *s);
+
+/*
+ * Read the solution of the segment if its value is higher than value.
+ * Returns NULL if there is none, or if it was being written. The
+ * returned solution is owned by the exchange and overwritten by the
+ * next import. Only one thread of a process may import.
+ *
+ * ex             : exchange (may be NULL: nothing is imported)
+ * value          : value to beat
+ * p              : instance of MKP
+ */
+const solution *import_incumbent(incumbent_exchange *ex, int value, const problem *p);
+
+/*
+ * Unmap the segment, which is left for the other processes.
+ *
+ * ex             : exchange to close
+ */
+void close_incumbent_exchange(incumbent_exchange *ex);
+
+#endif // __EXCHANGE_H__
@@ -21,19 +21,13 @@
 #include "genetic.h"
 
 
-int find_worst_member(solution **population,
-                      int population_size) {
-  int worst_value = INT_MAX;
-  int worst_index = 0;
-  // Basically an argmin function applied on
-  // the objective value of the members
-  for (int i = 0; i < population_size; i++) {
-    if (population[i]->value < worst_value) {
-      worst_value = population[i]->value;
-      worst_index = i; // Index of the current worst solution
-    }
-  }
-  return worst_index;
+ga_config create_ga_config(void) {
+  ga_config config;
+  config.population_size = 100;
+  config.mutation_rate = 2;
+  config.tournament_size = 2;
+  config.repair_order = REPAIR_DYNAMIC;
+  return(config);
 }
 
 int tournament(solution **population, const int const *indices,
@@ -58,174 +52,188 @@ int tournament(solution **population, const int const *indices,
 
 solution *crossover(const solution const *parent1,
                     const solution const *parent2,
-                    const problem const *p) {
-  // Create new empty solution
-  solution *child = create_empty_solution(p);
-  for (int item = 0; item < parent1->n; item++) {
-    // Take next binary character either from parent 1
-    // or from parent 2 with 0.5/0.5 probabilities.
-    if (((double)rand() / (double)RAND_MAX) < 0.5) {
-      child->sol[item] = parent1->sol[item];
-    } else {
-      child->sol[item] = parent2->sol[item];
+                    const problem const *p,
+                    solution_pool *pool,
+                    uint64_t *random_state) {
+  // The child starts as a copy of parent 1 (in a recycled buffer)
+  solution *child = acquire_solution(pool, p);
+  copy_solution(parent1, child, p);
+  for (int w = 0; w < N_WORDS(parent1->n); w++) {
+    // Each item where the parents differ is taken from parent 2
+    // with probability 0.5: a random mask selects 64 of them at once.
+    // Only those items are flipped, with delta evaluation.
+    uint64_t flips = (parent1->bits[w] ^ parent2->bits[w]) & random_word(random_state);
+    while (flips) {
+      int item = 64 * w + __builtin_ctzll(flips);
+      if (child->sol[item]) remove_item(child, item, p);
+      else add_item(child, item, p);
+      flips &= flips - 1;
     }
   }
-  // Because we modified the binary representation
-  // of the child "by hand", the quantities of
-  // resources used need to be updated, as well as the
-  // value of the objective function. This update is done
-  // here for speed purposes.
-  update_solution(child, p);
   return child;
 }
 
 void mutate(solution *individual,
             const problem const *p,
-            int *indices,
-            int mutation_rate) {
-  // Shuffle the item indices
-  shuffle_int(indices, individual->n);
-  // Select mutation_rate items without replacement
+            int mutation_rate,
+            uint64_t *random_state) {
+  int flipped[MAX_MUTATION_RATE];
+  if (mutation_rate > individual->n) mutation_rate = individual->n;
+  if (mutation_rate > MAX_MUTATION_RATE) mutation_rate = MAX_MUTATION_RATE;
+  // Select mutation_rate items without replacement,
+  // by rejecting the items that were already drawn
   for (int i = 0; i < mutation_rate; i++) {
-    int item = indices[i];
-    // Flip binary character
-    individual->sol[item] = 1 - individual->sol[item];
-  }
-  // We modified the binary representation of the 
-  // child "by hand" -> solution update
-  // (objective and resources).
-  update_solution(individual, p);
-}
-
-void repair(solution *individual,
-            const int const *indices,
-            const problem const *p) {
-
-  // DROP phase:
-  // While one of the capacity constraints is not satisfied,
-  // items are removed by reversed order of pseudo-utility.
-  for (int j = individual->n - 1; j > -1; j--) {
-    int item = indices[j];
-    if (individual->sol[item]) {
-      for (int i = 0; i < individual->m; i++) {
-        if (individual->resources_used[i] > p->capacities[i]) {
-          remove_item(individual, item, p);
-          // The item has been removed,
-          // it cannot be removed twice.
-          break;
-        }
-      }
-    }
-  }
-  // ADD phase:
-  // While solution remains feasible by adding items,
-  // items are inserted by order of pseudo-utility.
-  for (int j = 0; j < individual->n; j++) {
-    int item = indices[j];
-    check_and_add_item(individual, item, p);
+    int item, duplicate;
+    do {
+      item = random_int(random_state, individual->n);
+      duplicate = 0;
+      for (int k = 0; k < i; k++) duplicate |= (flipped[k] == item);
+    } while (duplicate);
+    flipped[i] = item;
+    // Flip binary character, with delta evaluation
+    if (individual->sol[item]) remove_item(individual, item, p);
+    else add_item(individual, item, p);
   }
 }
 
 solution *genetic_algorithm(const problem const *p,
-                            float max_time) {
-                      
-  int population_size = 100;
-  int mutation_rate = 2;
-  int pool_size = 2;
+                            float max_time,
+                            intensification *policy,
+                            const ga_config *config,
+                            elite_pool *elite,
+                            search_context *ctx) {
+  int population_size = config->population_size;
+  int mutation_rate = config->mutation_rate;
+  int pool_size = config->tournament_size;
   int t_max = 1000000 * p->n;
 
-  timer_t timer = create_timer(max_time);
+  mkp_timer_t timer = create_search_timer(ctx, max_time);
 
   // Currently best solution
   solution *best_solution = create_empty_solution(p);
 
-  // Necessary arrays for computing pseudo-utilities
-  // using Toyoda algorithm
-  float *u = (float *)malloc(p->m * sizeof(float));
-  float *v = (float *)malloc(p->n * sizeof(float));
-  float *pseudo_utilities = (float *)malloc(p->n * sizeof(float));
+  // Repair operator: DROP phase, then ADD phase
+  repair_engine *repairer = create_repair_engine(p, config->repair_order, 1, NULL);
 
-  // Necessary arrays for sorting items, randomly picking items
-  // and randomly sampling the population
-  int *member_indices = create_shuffled(population_size);
-  int *item_indices = create_shuffled(p->n);
+  // Participants of the two tournaments, drawn without replacement
+  int *participants = (int *)malloc(2 * pool_size * sizeof(int));
 
   // Initialize population by creating many solutions
-  // with the random insertion constructive heuristic
-  solution *population[population_size];
-  for (int i = 0; i < population_size; i++) {
-    population[i] = random_insertion(p);
+  // with the random insertion constructive heuristic,
+  // unless the population is restored from a snapshot
+  // (members first, then the best solution)
+  population *pop = create_population(population_size);
+  solution_pool *pool = create_solution_pool(population_size);
+  ls_workspace *ws = create_ls_workspace(p);
+  const snapshot *resume = resumed_snapshot(ctx, "ga", 2);
+  int n_saved = (resume != NULL) ? (resume->n_solutions - 1) : 0;
+  for (int i = 0; (i < n_saved) && (i < population_size); i++) {
+    solution *member = create_empty_solution(p);
+    load_solution(resume, i, member, p);
+    add_member(pop, member);
+  }
+  if ((resume == NULL) && (ctx->warm_start != NULL)) {
+    add_member(pop, clone_solution(ctx->warm_start, p));
   }
+  for (int i = pop->size; i < population_size; i++) {
+    add_member(pop, random_insertion(p, &ctx->random_state));
+  }
+  solution **members = pop->members;
 
   // Store currently best solution
-  int best = tournament(population, member_indices, 0, population_size);
-  copy_solution(population[best], best_solution, p);
-
   int t = 0;
+  if (resume != NULL) {
+    if ((n_saved == population_size) && (resume->n_order == population_size)) {
+      set_heap_order(pop, resume->order);
+    }
+    load_solution(resume, n_saved, best_solution, p);
+    t = (int)load_value(resume, "generation", 0);
+    policy->n_steps = (long long)load_value(resume, "intensify_steps", 0);
+    resume_search(resume, ctx, &timer);
+  } else {
+    copy_solution(members[get_best_member(pop)], best_solution, p);
+  }
+  report_incumbent(ctx, best_solution->value);
+  publish_incumbent(ctx->exchange, best_solution);
+
   while ((t < t_max) && !finished(&timer)) {
-    // Create two pools of individuals
-    // First pool: from member_indices[0] to member_indices[pool_size]
-    // Second pool: from member_indices[pool_size]
-    //              to member_indices[2*pool_size]
-    shuffle_int(member_indices, population_size);
-    int p1 = tournament(population, member_indices, 0, pool_size);
+    // A better solution found by another process replaces the worst member
+    const solution *shared = import_incumbent(ctx->exchange, best_solution->value, p);
+    if (shared != NULL) {
+      if (!has_member(pop, shared)) {
+        solution *member = acquire_solution(pool, p);
+        copy_solution(shared, member, p);
+        release_solution(pool, replace_member(pop, get_worst_member(pop), member));
+      }
+      copy_solution(shared, best_solution, p);
+      report_incumbent(ctx, best_solution->value);
+    }
+
+    // Snapshot of the search, taken between two generations
+    snapshot *snap = begin_snapshot(ctx, "ga", &timer, p);
+    if (snap != NULL) {
+      for (int i = 0; i < pop->size; i++) save_solution(snap, members[i]);
+      save_solution(snap, best_solution);
+      save_order(snap, pop->heap, pop->size);
+      save_value(snap, "generation", t);
+      save_value(snap, "intensify_steps", policy->n_steps);
+      commit_snapshot(ctx);
+    }
+
+    // Create two disjoint pools of individuals, in O(pool_size^2)
+    // whatever the population size
+    // First pool: from participants[0] to participants[pool_size]
+    // Second pool: from participants[pool_size]
+    //              to participants[2*pool_size]
+    sample_members(pop, 2 * pool_size, participants, &ctx->random_state);
+    int p1 = tournament(members, participants, 0, pool_size);
     int p2 = tournament(
-      population, member_indices, pool_size, 2*pool_size);
+      members, participants, pool_size, 2*pool_size);
 
     // Apply crossover operator between parents p1 and p2
-    solution *child = crossover(population[p1], population[p2], p);
+    solution *child = crossover(members[p1], members[p2], p, pool, &ctx->random_state);
 
     // Mutate newly created child solution
-    mutate(child, p, item_indices, mutation_rate);
+    mutate(child, p, mutation_rate, &ctx->random_state);
 
     // Apply repair operator on child solution if infeasible
-    if (!is_feasible(child, p)) {
-      compute_pseudo_utilities(u, v, pseudo_utilities, child, p);
-      indexes_of_sorted_array(item_indices, pseudo_utilities, p->n);
-      repair(child, item_indices, p);
-    }
+    repair_solution(repairer, child, NULL, p);
 
-    // Improve newly created solution with iterative best-fit
+    // Improve newly created solution with iterative best-fit,
+    // depending on the intensification policy.
     // The neighbourhood is of size 1 to avoid slowing down GA
-    improve_with_1_moves(child, p, GREEDY, BI, max_time);
+    if (should_intensify(policy, child, best_solution->value, &ctx->random_state)) {
+      intensify(policy, child, p, GREEDY, ws, &timer, ctx);
+    }
 
     // Determine whether the new feasible solution is identical
-    // to one of the members in the population
-    int is_duplicate = 0;
-    for (int i = 0; i < population_size; i++) {
-      if (are_identical(child, population[i])) {
-        is_duplicate = 1;
-        break;
-      }
-    }
-    if (is_duplicate) {
-      // Destroy new solution if duplicate
-      destroy_solution(child);
+    // to one of the members in the population (hash lookup)
+    if (has_member(pop, child)) {
+      // Recycle new solution if duplicate
+      release_solution(pool, child);
     } else {
-      // If new solution is unique, destroy and replace the worst
+      // If new solution is unique, replace and recycle the worst
       // member of the population (the one with lowest fitness)
-      int worst = find_worst_member(population, population_size);
-      destroy_solution(population[worst]);
-      population[worst] = child;
+      int worst = get_worst_member(pop);
+      release_solution(pool, replace_member(pop, worst, child));
+      offer_elite(elite, child, p);
 
       // Steady-state replacement
       if (child->value > best_solution->value) {
         copy_solution(child, best_solution, p);
+        report_incumbent(ctx, best_solution->value);
+        publish_incumbent(ctx->exchange, best_solution);
       }
     }
     t++;
   }
 
   // Deallocate memory
-  for (int i = 0; i < population_size; i++) {
-    free(population[i]);
-  }
-  free(population);
-  free(member_indices);
-  free(item_indices);
-  free(u);
-  free(v);
-  free(pseudo_utilities);
+  destroy_population(pop);
+  destroy_solution_pool(pool);
+  destroy_ls_workspace(ws);
+  destroy_repair_engine(repairer);
+  free(participants);
   return best_solution;
 }
 
@@ -26,19 +26,18 @@
 #include "perturbative.h"
 #include "mkpsolution.h"
 #include "mkpneighbourhood.h"
+#include "population.h"
+#include "solution_pool.h"
+#include "repair.h"
+#include "intensification.h"
+#include "checkpoint.h"
+#include "exchange.h"
 
 #include <stdint.h>
 
+// Maximum number of items flipped by a mutation
+#define MAX_MUTATION_RATE 64
 
-/*
- * Return the identifier of the member with lowest fitness.
- *
- * population      : Array of pointers to the members
- *                   of the population
- * population_size : Population size / array size
- */
-int find_worst_member(solution **population,
-                      int population_size);
 
 /*
  * Return the identifier of the member with highest fitness
@@ -62,47 +61,42 @@ int tournament(solution **population,
 
 /*
  * Create a new member/solution and add items to it
- * according to a uniform crossover operation.
+ * according to a uniform crossover operation. The child is a copy
+ * of parent 1 where each item differing in parent 2 is flipped with
+ * probability 0.5, using random 64-bit masks over the bitsets.
+ * Only the flipped items are evaluated, in O(m) each.
  *
  * parent1         : First parent solution
  * parent2         : Second parent solution
  * p               : instance of MKP
+ * pool            : pool the child is taken from
+ * random_state    : state of the random generator
  */
 solution *crossover(const solution const *parent1,
                     const solution const *parent2,
-                    const problem const *p);
+                    const problem const *p,
+                    solution_pool *pool,
+                    uint64_t *random_state);
 
 /*
  * Apply multiple mutations to a solution.
  *
  * individual      : solution to mutate
  * p               : instance of MKP
- * indices         : indirect indices of the items.
- *                   This array is shuffled in order to
- *                   randomly select items in solution.
- * mutation_rate   : number of mutations to apply
+ * mutation_rate   : number of distinct items to flip
+ *                   (at most MAX_MUTATION_RATE)
+ * random_state    : state of the random generator
  */
 void mutate(solution *individual,
             const problem const *p,
-            int *indices,
-            int mutation_rate);
+            int mutation_rate,
+            uint64_t *random_state);
 
 /*
- * Make a solution feasible by dropping the less profitable
- * items first (DROP phase). If the resulting feasible solution
- * leaves some sufficiently large gaps, the most profitable
- * items are added first (ADD phase). The order for
- * dding/removing is determined by item pseudo-utilities.
- *
- * individual      : infeasible solution
- * indices         : indirect indices of the items.
- *                   This array is used to sort the indices
- *                   according to item pseudo-utilities.
- * p               : instance of MKP
+ * Default settings of GA: 100 members, 2 mutations per child,
+ * binary tournaments and dynamic repair order.
  */
-void repair(solution *individual,
-            const int const *indices,
-            const problem const *p);
+ga_config create_ga_config(void);
 
 /*
  * Generate a feasible solution with a genetic algorithm.
@@ -110,8 +104,19 @@ void repair(solution *individual,
  * p               : instance of MKP
  * max_time        : maximum execution time. If max_time <= 0,
  *                   then time is not used as stopping criterion.
+ * policy          : when to improve new children with local search
+ * config          : settings of GA
+ * elite           : pool where new members are offered (can be NULL)
+ * ctx             : context of the solve (random state, incumbents), with
+ *                   the checkpoints of the population taken between two
+ *                   generations, the snapshot to resume from, and the
+ *                   warm start added to the initial population
  */
 solution *genetic_algorithm(const problem const *p,
-                            float max_time);
+                            float max_time,
+                            intensification *policy,
+                            const ga_config *config,
+                            elite_pool *elite,
+                            search_context *ctx);
 
 #endif // __GENETIC_H__
\ No newline at end of file
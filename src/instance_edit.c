@@ -0,0 +1,207 @@
+/***************************************************************************
+ *   Copyright (C) 2018 Antoine Passemiers                                 *
+ *   apassemi@ulb.ac.be                                                    *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#include "instance_edit.h"
+
+
+instance_editor *create_instance_editor(problem *p, solution *s) {
+  instance_editor *ed = (instance_editor *)malloc(sizeof(instance_editor));
+  ed->p = p;
+  ed->s = s;
+  ed->profit_total = 0;
+  for (int j = 0 ; j < p->n ; j++) ed->profit_total += llabs(p->profits[j]);
+  ed->weight_totals = (int64_t *)malloc(p->m * sizeof(int64_t));
+  for (int i = 0 ; i < p->m ; i++) {
+    ed->weight_totals[i] = llabs(p->capacities[i]);
+    for (int j = 0 ; j < p->n ; j++) ed->weight_totals[i] += llabs(p->constraints[i][j]);
+  }
+  ed->item_capacity = p->n;
+  ed->nz_capacity = p->sparse ? p->nz_start[p->n] : 0;
+  ed->changes = 0;
+  return(ed);
+}
+
+int edit_capacity(instance_editor *ed, int knapsack, int capacity) {
+  problem *p = ed->p;
+  if ((knapsack < 0) || (knapsack >= p->m)) return(0);
+  int64_t total = ed->weight_totals[knapsack] - llabs(p->capacities[knapsack]) + llabs(capacity);
+  if (total > INT_MAX) return(0);
+  ed->weight_totals[knapsack] = total;
+  p->capacities[knapsack] = capacity;
+  p->best_known = 0;
+  ed->changes |= EDIT_CAPACITIES;
+  return(1);
+}
+
+int edit_profit(instance_editor *ed, int item, int profit) {
+  problem *p = ed->p;
+  if ((item < 0) || (item >= p->n)) return(0);
+  int64_t total = ed->profit_total - llabs(p->profits[item]) + llabs(profit);
+  if (total > INT_MAX) return(0);
+  ed->profit_total = total;
+  if (ed->s->sol[item]) ed->s->value += profit - p->profits[item];
+  p->profits[item] = profit;
+  p->best_known = 0;
+  ed->changes |= EDIT_PROFITS;
+  return(1);
+}
+
+// Store the dense item-major weights on 32 bits, when a new weight
+// does not fit in 16 bits
+static void widen_weights(problem *p, int capacity) {
+  p->weights = (int *)malloc((size_t)capacity * p->m * sizeof(int));
+  for (size_t k = 0 ; k < (size_t)p->n * p->m ; k++) p->weights[k] = p->weights16[k];
+  free(p->weights16);
+  p->weights16 = NULL;
+}
+
+// Make room for one more item in the arrays of the instance and the
+// solution, doubling their capacity when they are full
+static void reserve_item(instance_editor *ed) {
+  problem *p = ed->p;
+  solution *s = ed->s;
+  if (p->n < ed->item_capacity) return;
+  int capacity = 2 * ed->item_capacity;
+  p->profits = (int *)realloc(p->profits, capacity * sizeof(int));
+  for (int i = 0 ; i < p->m ; i++) {
+    p->constraints[i] = (int *)realloc(p->constraints[i], capacity * sizeof(int));
+  }
+  p->zobrist = (uint64_t *)realloc(p->zobrist, capacity * sizeof(uint64_t));
+  for (int j = p->n ; j < capacity ; j++) p->zobrist[j] = zobrist_key(j);
+  if (p->sparse) {
+    p->nz_start = (int *)realloc(p->nz_start, (capacity + 1) * sizeof(int));
+  } else if (p->weights16 != NULL) {
+    p->weights16 = (int16_t *)realloc(p->weights16, (size_t)capacity * p->m * sizeof(int16_t));
+  } else {
+    p->weights = (int *)realloc(p->weights, (size_t)capacity * p->m * sizeof(int));
+  }
+
+  // Items beyond n are never selected
+  s->sol = (int *)realloc(s->sol, capacity * sizeof(int));
+  memset(s->sol + p->n, 0x00, (capacity - p->n) * sizeof(int));
+  s->bits = (uint64_t *)realloc(s->bits, N_WORDS(capacity) * sizeof(uint64_t));
+  memset(s->bits + N_WORDS(p->n), 0x00,
+         (N_WORDS(capacity) - N_WORDS(p->n)) * sizeof(uint64_t));
+  ed->item_capacity = capacity;
+}
+
+int edit_add_item(instance_editor *ed, int profit, const int *weights) {
+  problem *p = ed->p;
+  if (ed->profit_total + llabs(profit) > INT_MAX) return(-1);
+  for (int i = 0 ; i < p->m ; i++) {
+    if (ed->weight_totals[i] + llabs(weights[i]) > INT_MAX) return(-1);
+  }
+  reserve_item(ed);
+  int item = p->n;
+  ed->profit_total += llabs(profit);
+  p->profits[item] = profit;
+  for (int i = 0 ; i < p->m ; i++) {
+    ed->weight_totals[i] += llabs(weights[i]);
+    p->constraints[i][item] = weights[i];
+  }
+
+  // Item-major copy of the weights, in the representation of the instance
+  if (p->sparse) {
+    int nnz = p->nz_start[item];
+    int needed = nnz;
+    for (int i = 0 ; i < p->m ; i++) needed += (weights[i] != 0);
+    if (needed > ed->nz_capacity) {
+      ed->nz_capacity = (2 * ed->nz_capacity > needed) ? (2 * ed->nz_capacity) : needed;
+      p->nz_rows = (int *)realloc(p->nz_rows, ed->nz_capacity * sizeof(int));
+      p->nz_weights = (int *)realloc(p->nz_weights, ed->nz_capacity * sizeof(int));
+    }
+    for (int i = 0 ; i < p->m ; i++) {
+      if (weights[i] != 0) {
+        p->nz_rows[nnz] = i;
+        p->nz_weights[nnz++] = weights[i];
+      }
+    }
+    p->nz_start[item + 1] = nnz;
+  } else {
+    if (p->weights16 != NULL) {
+      for (int i = 0 ; i < p->m ; i++) {
+        if ((weights[i] < INT16_MIN) || (weights[i] > INT16_MAX)) {
+          widen_weights(p, ed->item_capacity);
+          break;
+        }
+      }
+    }
+    for (int i = 0 ; i < p->m ; i++) {
+      size_t k = (size_t)item * p->m + i;
+      if (p->weights16 != NULL) p->weights16[k] = (int16_t)weights[i];
+      else p->weights[k] = weights[i];
+    }
+  }
+  p->n++;
+  ed->s->n = p->n;
+  p->best_known = 0;
+  ed->changes |= EDIT_ITEMS;
+  return(item);
+}
+
+int edit_remove_item(instance_editor *ed, int item) {
+  problem *p = ed->p;
+  solution *s = ed->s;
+  int last = p->n - 1;
+  if ((item < 0) || (item > last) || (last == 0)) return(0);
+
+  // The last item is taken out of the solution while it moves
+  if (s->sol[item]) remove_item(s, item, p);
+  int moved = (item != last) && s->sol[last];
+  if (moved) remove_item(s, last, p);
+
+  ed->profit_total -= llabs(p->profits[item]);
+  p->profits[item] = p->profits[last];
+  for (int i = 0 ; i < p->m ; i++) {
+    ed->weight_totals[i] -= llabs(p->constraints[i][item]);
+    p->constraints[i][item] = p->constraints[i][last];
+  }
+  if (p->sparse && (item != last)) {
+    // The nonzeros of the last item replace those of the removed one,
+    // the nonzeros in between are shifted accordingly
+    int start = p->nz_start[item], end = p->nz_start[item + 1];
+    int last_start = p->nz_start[last], n_last = p->nz_start[p->n] - last_start;
+    int delta = n_last - (end - start);
+    int *moved_nz = (int *)malloc(2 * (n_last + 1) * sizeof(int));
+    memcpy(moved_nz, p->nz_rows + last_start, n_last * sizeof(int));
+    memcpy(moved_nz + n_last, p->nz_weights + last_start, n_last * sizeof(int));
+    memmove(p->nz_rows + end + delta, p->nz_rows + end, (last_start - end) * sizeof(int));
+    memmove(p->nz_weights + end + delta, p->nz_weights + end, (last_start - end) * sizeof(int));
+    memcpy(p->nz_rows + start, moved_nz, n_last * sizeof(int));
+    memcpy(p->nz_weights + start, moved_nz + n_last, n_last * sizeof(int));
+    free(moved_nz);
+    for (int j = item + 1 ; j <= last ; j++) p->nz_start[j] += delta;
+  } else if (!p->sparse && (item != last)) {
+    size_t to = (size_t)item * p->m, from = (size_t)last * p->m;
+    if (p->weights16 != NULL) memcpy(p->weights16 + to, p->weights16 + from, p->m * sizeof(int16_t));
+    else memcpy(p->weights + to, p->weights + from, p->m * sizeof(int));
+  }
+  p->n--;
+  s->n = p->n;
+  if (moved) add_item(s, item, p);
+  p->best_known = 0;
+  ed->changes |= EDIT_ITEMS;
+  return(1);
+}
+
+void destroy_instance_editor(instance_editor *ed) {
+  free(ed->weight_totals);
+  free(ed);
+}
@@ -0,0 +1,125 @@
+/***************************************************************************
+ *   Copyright (C) 2018 Antoine Passemiers                                 *
+ *   apassemi@ulb.ac.be                                                    *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#ifndef __INSTANCE_EDIT_H__
+#define __INSTANCE_EDIT_H__
+
+#include "mkpproblem.h"
+#include "mkpsolution.h"
+#include "mkpneighbourhood.h"
+
+// Kinds of edits since the last solve, as bit flags
+#define EDIT_PROFITS    1
+#define EDIT_CAPACITIES 2
+#define EDIT_ITEMS      4
+
+/*
+ * Editor applying small changes to an instance in place, while keeping
+ * a solution consistent with the instance: its value, resources used,
+ * hash and bitset always match the edited instance. Edits take time
+ * proportional to the change (O(m) per item, amortized), except the
+ * removal of an item from a sparse instance, which shifts the nonzeros
+ * of the following items (O(nnz + n)). The solution may become
+ * infeasible when a capacity decreases; mkp_reoptimize repairs it
+ * before resuming the search (see mkpsolver.h). Other solutions of the
+ * instance are invalidated by edits of items.
+ *
+ * Items are removed by moving the last item into the place of the
+ * removed one, so that the other indices do not change. Overflows are
+ * checked as in fits_in_int, with totals updated along with the edits.
+ *
+ * p              : instance being edited
+ * s              : solution kept consistent with p
+ * profit_total   : sum of the absolute profits
+ * weight_totals  : for each knapsack, the capacity plus the sum of the
+ *                  absolute weights (absolute values)
+ * item_capacity  : number of items the arrays of p and s can hold
+ * nz_capacity    : number of nonzero weights the sparse arrays can hold
+ * changes        : EDIT_* flags of the edits since the last solve
+ */
+typedef struct _instance_editor {
+  problem *p;
+  solution *s;
+  int64_t profit_total;
+  int64_t *weight_totals;
+  int item_capacity;
+  int nz_capacity;
+  int changes;
+} instance_editor;
+
+/*
+ * Create an editor, in O(nm). The editor does not own the instance nor
+ * the solution, whose arrays it reallocates when items are added.
+ *
+ * p              : instance to edit
+ * s              : solution of p to keep consistent
+ */
+instance_editor *create_instance_editor(problem *p, solution *s);
+
+/*
+ * Change the capacity of a knapsack. Returns 0, leaving the instance
+ * unchanged, if the index is invalid or the instance would overflow.
+ *
+ * ed             : editor
+ * knapsack       : index of the knapsack
+ * capacity       : new capacity
+ */
+int edit_capacity(instance_editor *ed, int knapsack, int capacity);
+
+/*
+ * Change the profit of an item. Returns 0, leaving the instance
+ * unchanged, if the index is invalid or the instance would overflow.
+ *
+ * ed             : editor
+ * item           : index of the item
+ * profit         : new profit
+ */
+int edit_profit(instance_editor *ed, int item, int profit);
+
+/*
+ * Add an item, not selected in the solution. Returns its index (the
+ * former number of items), or -1, leaving the instance unchanged,
+ * if the instance would overflow.
+ *
+ * ed             : editor
+ * profit         : profit of the item
+ * weights        : vector of length m containing its weights
+ */
+int edit_add_item(instance_editor *ed, int profit, const int *weights);
+
+/*
+ * Remove an item, which is first removed from the solution. The last
+ * item takes its index, in O(m) on dense instances and O(nnz + n) on
+ * sparse ones. Returns 0, leaving the instance unchanged, if the index
+ * is invalid or the item is the only one.
+ *
+ * ed             : editor
+ * item           : index of the item
+ */
+int edit_remove_item(instance_editor *ed, int item);
+
+/*
+ * Deallocate an editor, leaving the instance and the solution as edited.
+ *
+ * ed             : editor to deallocate
+ */
+void destroy_instance_editor(instance_editor *ed);
+
+#endif // __INSTANCE_EDIT_H__
@@ -0,0 +1,214 @@
+/***************************************************************************
+ *   Copyright (C) 2018 Antoine Passemiers                                 *
+ *   apassemi@ulb.ac.be                                                    *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#include "instance_stream.h"
+
+
+// Read the next integer, skipping blanks.
+// Returns 0 at the end of the file, on any other character,
+// or if the integer does not fit in an int.
+static int read_int(FILE *file, int *value) {
+  int c = getc_unlocked(file);
+  while ((c == ' ') || (c == '\t') || (c == '\n') || (c == '\r')) c = getc_unlocked(file);
+  int sign = 1;
+  if (c == '-') {
+    sign = -1;
+    c = getc_unlocked(file);
+  }
+  if ((c < '0') || (c > '9')) return(0);
+  int64_t x = 0;
+  while ((c >= '0') && (c <= '9')) {
+    x = 10 * x + (c - '0');
+    if (x > INT_MAX) return(0);
+    c = getc_unlocked(file);
+  }
+  ungetc(c, file);
+  *value = sign * (int)x;
+  return(1);
+}
+
+// Whether only blanks remain on the current line
+static int at_end_of_line(FILE *file) {
+  int c = getc_unlocked(file);
+  while ((c == ' ') || (c == '\t') || (c == '\r')) c = getc_unlocked(file);
+  ungetc(c, file);
+  return((c == '\n') || (c == EOF));
+}
+
+static void destroy_buffer(instance_stream *stream) {
+  problem *p = stream->p;
+  if (p == NULL) return;
+  free(p->profits);
+  for (int i = 0 ; i < stream->max_m ; i++) free(p->constraints[i]);
+  free(p->constraints);
+  destroy_item_major_weights(p);
+  free(p->capacities);
+  free(p->zobrist);
+  free(p);
+  stream->p = NULL;
+}
+
+// Make the buffer large enough for an instance of n items and m knapsacks
+static void reserve_buffer(instance_stream *stream, int n, int m) {
+  if ((stream->p != NULL) && (n <= stream->max_n) && (m <= stream->max_m)) return;
+  if (stream->p != NULL) {
+    if (n < stream->max_n) n = stream->max_n;
+    if (m < stream->max_m) m = stream->max_m;
+    destroy_buffer(stream);
+  }
+  problem *p = (problem *)malloc(sizeof(problem));
+  p->n = n;
+  p->m = m;
+  p->profits = (int *)malloc(n * sizeof(int));
+  p->constraints = (int **)malloc(m * sizeof(int *));
+  for (int i = 0 ; i < m ; i++) p->constraints[i] = (int *)malloc(n * sizeof(int));
+  p->weights = p->nz_start = p->nz_rows = p->nz_weights = NULL;
+  p->weights16 = NULL;
+  p->capacities = (int *)malloc(m * sizeof(int));
+  // Keys only depend on the item index, they stay valid for smaller instances
+  create_zobrist_keys(p);
+  stream->p = p;
+  stream->max_n = n;
+  stream->max_m = m;
+}
+
+instance_stream *create_instance_stream(void) {
+  instance_stream *stream = (instance_stream *)malloc(sizeof(instance_stream));
+  stream->file = NULL;
+  stream->n_instances = 0;
+  stream->index = 0;
+  stream->error = 0;
+  stream->header_n = 0;
+  stream->p = NULL;
+  stream->max_n = 0;
+  stream->max_m = 0;
+  return(stream);
+}
+
+int reopen_instance_stream(instance_stream *stream, FILE *file) {
+  if (stream->file != NULL) close_file(stream->file);
+  stream->file = file;
+  stream->n_instances = 0;
+  stream->index = 0;
+  stream->error = 0;
+  stream->header_n = 0;
+
+  // A collection starts with the number of instances alone on its line,
+  // a single instance with "n m b"
+  int first;
+  if (!read_int(stream->file, &first) || (first <= 0)) {
+    stream->error = 1;
+  } else if (at_end_of_line(stream->file)) {
+    stream->n_instances = first;
+  } else {
+    stream->n_instances = 1;
+    stream->header_n = first;
+  }
+  return(!stream->error);
+}
+
+instance_stream *open_instance_stream(char *filename) {
+  instance_stream *stream = create_instance_stream();
+  FILE *file = fopen(filename, "r");
+  if (file == NULL) {
+    fprintf(stderr, "error opening input file %s\n", filename);
+    stream->error = 1;
+  } else {
+    reopen_instance_stream(stream, file);
+  }
+  return(stream);
+}
+
+problem *next_instance(instance_stream *stream) {
+  if (stream->error || (stream->index >= stream->n_instances)) return(NULL);
+  FILE *file = stream->file;
+  int n, m, b;
+  // The size of a single instance was read with the header
+  if ((stream->index == 0) && (stream->header_n != 0)) n = stream->header_n;
+  else if (!read_int(file, &n)) n = 0;
+  if ((n <= 0) || !read_int(file, &m) || (m <= 0) || !read_int(file, &b)) {
+    stream->error = 1;
+    return(NULL);
+  }
+
+  reserve_buffer(stream, n, m);
+  problem *p = stream->p;
+  p->n = n;
+  p->m = m;
+  p->best_known = b;
+  int ok = 1;
+  for (int j = 0 ; ok && (j < n) ; j++) ok = read_int(file, &p->profits[j]);
+  for (int i = 0 ; ok && (i < m) ; i++) {
+    for (int j = 0 ; ok && (j < n) ; j++) {
+      ok = read_int(file, &p->constraints[i][j]);
+    }
+  }
+  for (int i = 0 ; ok && (i < m) ; i++) ok = read_int(file, &p->capacities[i]);
+  if (!ok || !fits_in_int(p)) {
+    stream->error = 1;
+    return(NULL);
+  }
+  // The representation of the weights depends on the density
+  destroy_item_major_weights(p);
+  create_item_major_weights(p);
+  stream->index++;
+  return(p);
+}
+
+problem *read_binary_instance(instance_stream *stream, const int32_t *data, size_t n_words) {
+  if (n_words < 3) return(NULL);
+  int n = data[0], m = data[1];
+  if ((n <= 0) || (m <= 0) || \
+      ((uint64_t)n * (m + 1) + m + 3 != (uint64_t)n_words)) {
+    return(NULL);
+  }
+  reserve_buffer(stream, n, m);
+  problem *p = stream->p;
+  p->n = n;
+  p->m = m;
+  p->best_known = data[2];
+  const int32_t *x = data + 3;
+  for (int j = 0 ; j < n ; j++) p->profits[j] = *x++;
+  for (int i = 0 ; i < m ; i++) {
+    for (int j = 0 ; j < n ; j++) p->constraints[i][j] = *x++;
+  }
+  for (int i = 0 ; i < m ; i++) p->capacities[i] = *x++;
+  if (!fits_in_int(p)) return(NULL);
+  destroy_item_major_weights(p);
+  create_item_major_weights(p);
+  return(p);
+}
+
+int write_binary_instance(FILE *file, const problem *p) {
+  int32_t header[3] = {p->n, p->m, p->best_known};
+  int ok = (fwrite(header, sizeof(int32_t), 3, file) == 3);
+  ok = ok && (fwrite(p->profits, sizeof(int32_t), p->n, file) == (size_t)p->n);
+  for (int i = 0 ; ok && (i < p->m) ; i++) {
+    ok = (fwrite(p->constraints[i], sizeof(int32_t), p->n, file) == (size_t)p->n);
+  }
+  ok = ok && (fwrite(p->capacities, sizeof(int32_t), p->m, file) == (size_t)p->m);
+  return(ok);
+}
+
+void close_instance_stream(instance_stream *stream) {
+  if (stream->file != NULL) close_file(stream->file);
+  destroy_buffer(stream);
+  free(stream);
+}
@@ -0,0 +1,122 @@
+/***************************************************************************
+ *   Copyright (C) 2018 Antoine Passemiers                                 *
+ *   apassemi@ulb.ac.be                                                    *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#ifndef __INSTANCE_STREAM_H__
+#define __INSTANCE_STREAM_H__
+
+#include "mkpproblem.h"
+
+/*
+ * Lazy reader of the instances stored in one file. Two layouts are
+ * recognized from the first line:
+ *   - a single instance: "n m b", then the n profits, the m x n
+ *     constraint matrix and the m capacities;
+ *   - an OR-Library collection (mknapcb*.txt): the number of instances
+ *     alone on the first line, followed by that many single instances.
+ * Instances are parsed one at a time into a problem buffer owned by the
+ * stream, which is only reallocated when an instance is larger than all
+ * the previous ones, so that memory does not depend on the file size.
+ *
+ * file           : file being read
+ * n_instances    : number of instances announced by the file
+ * index          : number of instances read so far
+ * error          : whether the file is malformed or truncated
+ * header_n       : number of items of a single instance, read with
+ *                  the header (0 for collections)
+ * p              : problem buffer holding the last instance read
+ * max_n, max_m   : dimensions the buffer is allocated for
+ */
+typedef struct _instance_stream {
+  FILE *file;
+  int n_instances;
+  int index;
+  int error;
+  int header_n;
+  problem *p;
+  int max_n;
+  int max_m;
+} instance_stream;
+
+/*
+ * Create a stream without file, whose problem buffer is kept for the
+ * files attached later with reopen_instance_stream.
+ */
+instance_stream *create_instance_stream(void);
+
+/*
+ * Read the instances of another file with the same problem buffer.
+ * The previous file is closed, and the stream takes ownership of the
+ * new one. Returns 0, setting stream->error, if the header is malformed.
+ *
+ * stream         : stream of instances
+ * file           : file to read, positioned at its header
+ */
+int reopen_instance_stream(instance_stream *stream, FILE *file);
+
+/*
+ * Open a file of instances and read its header. If the file cannot be
+ * opened, stream->file is NULL and stream->error is set.
+ *
+ * filename       : path to the file
+ */
+instance_stream *open_instance_stream(char *filename);
+
+/*
+ * Parse the next instance of the stream. The returned problem belongs to
+ * the stream and is overwritten by the next call: solvers must be done
+ * with it before. Returns NULL after the last instance, or if the file
+ * is malformed or the instance overflows an int (see fits_in_int),
+ * in which case stream->error is set.
+ *
+ * stream         : stream of instances
+ */
+problem *next_instance(instance_stream *stream);
+
+/*
+ * Load an instance stored in the binary layout into the problem buffer
+ * of a stream: n, m and the best known value, the n profits, the m x n
+ * constraint matrix row by row and the m capacities, as 32-bit integers
+ * in host byte order. Returns NULL if the size does not match n and m
+ * or if the instance overflows an int (see fits_in_int). The returned
+ * problem belongs to the stream, as with next_instance.
+ *
+ * stream         : stream whose buffer receives the instance
+ * data           : instance in the binary layout
+ * n_words        : number of 32-bit integers in data
+ */
+problem *read_binary_instance(instance_stream *stream, const int32_t *data, size_t n_words);
+
+/*
+ * Write an instance in the binary layout (see read_binary_instance).
+ * Returns 0 on write errors.
+ *
+ * file           : destination
+ * p              : instance of MKP
+ */
+int write_binary_instance(FILE *file, const problem *p);
+
+/*
+ * Close the file and deallocate the stream with its problem buffer.
+ *
+ * stream         : stream to close
+ */
+void close_instance_stream(instance_stream *stream);
+
+#endif // __INSTANCE_STREAM_H__
@@ -0,0 +1,70 @@
+/***************************************************************************
+ *   Copyright (C) 2018 Antoine Passemiers                                 *
+ *   apassemi@ulb.ac.be                                                    *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#include "intensification.h"
+
+
+intensification create_intensification(enum intensification_mode mode) {
+  intensification policy;
+  policy.mode = mode;
+  policy.every_k = 10;
+  policy.probability = 0.1;
+  policy.within = 0.01;
+  policy.max_moves = 0;
+  policy.max_time = -1;
+  policy.n_steps = 0;
+  return(policy);
+}
+
+int should_intensify(intensification *policy, const solution *s, int best_value,
+                     uint64_t *random_state) {
+  long long step = policy->n_steps++;
+  switch (policy->mode) {
+    case INTENSIFY_ALWAYS:
+    case INTENSIFY_FIRST_IMPROVEMENT:
+      return(1);
+    case INTENSIFY_EVERY_K:
+      return((step % policy->every_k) == 0);
+    case INTENSIFY_PROBABILISTIC:
+      return(random_uniform(random_state) < policy->probability);
+    case INTENSIFY_NEAR_BEST:
+      return(s->value >= (1.0 - policy->within) * best_value);
+    default:
+      return(0);
+  }
+}
+
+void intensify(const intensification *policy,
+               solution *s,
+               const problem *p,
+               enum constructive h,
+               ls_workspace *ws,
+               const mkp_timer_t *deadline,
+               search_context *ctx) {
+  enum perturbative nm = (policy->mode == INTENSIFY_FIRST_IMPROVEMENT) ? FI : BI;
+  // The local search also stops when the caller runs out of time
+  float max_time = policy->max_time;
+  if ((deadline != NULL) && deadline->active) {
+    float remaining = deadline->max_time - elapsed_time(deadline);
+    if (remaining <= 0) return;
+    if ((max_time <= 0) || (remaining < max_time)) max_time = remaining;
+  }
+  improve_with_1_moves(s, p, h, nm, policy->max_moves, max_time, NULL, ws, ctx);
+}
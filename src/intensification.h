@@ -0,0 +1,71 @@
+/***************************************************************************
+ *   Copyright (C) 2018 Antoine Passemiers                                 *
+ *   apassemi@ulb.ac.be                                                    *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#ifndef __INTENSIFICATION_H__
+#define __INTENSIFICATION_H__
+
+#include "mkpdata.h"
+#include "mkpalgotypes.h"
+#include "perturbative.h"
+
+/*
+ * Create an intensification policy with default parameters:
+ * every 10 steps, probability 0.1, within 1% of the best,
+ * no move cap and no time budget.
+ *
+ * mode           : when to apply the local search
+ */
+intensification create_intensification(enum intensification_mode mode);
+
+/*
+ * Tell whether a new solution must be improved with local search.
+ * Each call counts as one step of the policy.
+ *
+ * policy         : intensification policy
+ * s              : new solution
+ * best_value     : objective value of the best solution found so far
+ * random_state   : state of the random generator (INTENSIFY_PROBABILISTIC)
+ */
+int should_intensify(intensification *policy, const solution *s, int best_value,
+                     uint64_t *random_state);
+
+/*
+ * Improve a solution with the 1-move local search of the policy
+ * (first-improvement for INTENSIFY_FIRST_IMPROVEMENT, best-improvement
+ * otherwise), within the move and time budgets of the policy and the
+ * time left to the caller.
+ *
+ * policy         : intensification policy
+ * s              : solution to improve in place
+ * p              : instance of MKP
+ * h              : heuristic used to refill the solution after a removal
+ * ws             : scratch memory of the local search (can be NULL)
+ * deadline       : timer of the caller (can be NULL)
+ * ctx            : context of the solve
+ */
+void intensify(const intensification *policy,
+               solution *s,
+               const problem *p,
+               enum constructive h,
+               ls_workspace *ws,
+               const mkp_timer_t *deadline,
+               search_context *ctx);
+
+#endif // __INTENSIFICATION_H__
@@ -0,0 +1,207 @@
+/***************************************************************************
+ *   Copyright (C) 2018 Antoine Passemiers                                 *
+ *   apassemi@ulb.ac.be                                                    *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#include "kernel_search.h"
+
+/*
+ * Batch of subproblems solved concurrently. Workers pick the next
+ * unsolved subproblem with an atomic increment of next. The context
+ * of the subproblems only passes on the cancellation of the solve:
+ * their incumbents are not solutions of the instance.
+ */
+typedef struct _ks_batch {
+  ks_subproblem **subproblems;
+  int n_subproblems;
+  int next;
+  float time_limit;
+  search_context *sub_ctx;
+} ks_batch;
+
+
+ks_subproblem *create_ks_subproblem(const solution *s,
+                                    const int *items,
+                                    int n_free,
+                                    const problem *p) {
+  int m = p->m;
+  ks_subproblem *ksp = (ks_subproblem *)malloc(sizeof(ks_subproblem));
+  ksp->n_free = n_free;
+  ksp->items = (int *)malloc(n_free * sizeof(int));
+  memcpy(ksp->items, items, n_free * sizeof(int));
+
+  // Residual capacities: resources left by the fixed variables
+  int *profits = (int *)malloc(n_free * sizeof(int));
+  int *capacities = (int *)malloc(m * sizeof(int));
+  int **constraints = (int **)malloc(m * sizeof(int *));
+  for (int i = 0 ; i < m ; i++) {
+    capacities[i] = p->capacities[i] - s->resources_used[i];
+    constraints[i] = (int *)malloc(n_free * sizeof(int));
+  }
+  for (int k = 0 ; k < n_free ; k++) {
+    int j = items[k];
+    profits[k] = p->profits[j];
+    for (int i = 0 ; i < m ; i++) {
+      constraints[i][k] = p->constraints[i][j];
+      if (s->sol[j]) capacities[i] += p->constraints[i][j];
+    }
+  }
+  ksp->sub = create_problem(n_free, m, 0, profits, constraints, capacities);
+
+  ksp->initial = create_empty_solution(ksp->sub);
+  for (int k = 0 ; k < n_free ; k++) {
+    if (s->sol[items[k]]) add_item(ksp->initial, k, ksp->sub);
+  }
+  ksp->result = NULL;
+  ksp->gain = 0;
+  return(ksp);
+}
+
+void destroy_ks_subproblem(ks_subproblem *ksp) {
+  if (ksp->result != NULL) destroy_solution(ksp->result);
+  destroy_solution(ksp->initial);
+  destroy_problem(ksp->sub);
+  free(ksp->items);
+  free(ksp);
+}
+
+static void *ks_worker_run(void *arg) {
+  ks_batch *batch = (ks_batch *)arg;
+  int k;
+  while ((k = __atomic_fetch_add(&batch->next, 1, __ATOMIC_ACQ_REL)) < batch->n_subproblems) {
+    ks_subproblem *ksp = batch->subproblems[k];
+    ksp->result = branch_and_bound(ksp->sub, ksp->initial, DEPTH_FIRST, 1,
+                                   batch->time_limit, NULL, batch->sub_ctx);
+    ksp->gain = ksp->result->value - ksp->initial->value;
+  }
+  return(NULL);
+}
+
+static int ks_cmp_gain_decreasing(const void *a, const void *b) {
+  const ks_subproblem *k1 = *(const ks_subproblem **)a;
+  const ks_subproblem *k2 = *(const ks_subproblem **)b;
+  return(k2->gain - k1->gain);
+}
+
+// Set the free variables of s to their values in the subproblem solution.
+// The move is undone if it makes s infeasible. Returns 1 if applied.
+static int ks_apply(solution *s, const ks_subproblem *ksp, const problem *p) {
+  for (int k = 0 ; k < ksp->n_free ; k++) {
+    if (ksp->result->sol[k]) add_item(s, ksp->items[k], p);
+    else remove_item(s, ksp->items[k], p);
+  }
+  if (is_feasible(s, p)) return(1);
+  for (int k = 0 ; k < ksp->n_free ; k++) {
+    if (ksp->initial->sol[k]) add_item(s, ksp->items[k], p);
+    else remove_item(s, ksp->items[k], p);
+  }
+  return(0);
+}
+
+void kernel_search(solution *s,
+                   const problem *p,
+                   int bucket_size,
+                   float subproblem_time,
+                   int n_threads,
+                   float max_time,
+                   elite_pool *elite,
+                   search_context *ctx) {
+  if (n_threads < 1) n_threads = 1;
+  int half = (bucket_size < 2) ? 1 : (bucket_size / 2);
+  mkp_timer_t timer = create_search_timer(ctx, max_time);
+  surrogate *sr = create_surrogate(p, 100);
+
+  int *selected = (int *)malloc(p->n * sizeof(int));
+  int *discarded = (int *)malloc(p->n * sizeof(int));
+  int *items = (int *)malloc(2 * half * sizeof(int));
+  ks_subproblem **subproblems = (ks_subproblem **)malloc(n_threads * sizeof(ks_subproblem *));
+  pthread_t *threads = (pthread_t *)malloc(n_threads * sizeof(pthread_t));
+  search_context sub_ctx;
+  init_search_context(&sub_ctx, 0);
+  sub_ctx.cancel = (ctx != NULL) ? ctx->cancel : NULL;
+
+  int improving = 1;
+  while (improving && !finished(&timer)) {
+    improving = 0;
+    // Selected items by increasing efficiency,
+    // discarded items by decreasing efficiency
+    int n_selected = 0, n_discarded = 0;
+    for (int r = 0 ; r < p->n ; r++) {
+      int j = sr->order[r];
+      if (!s->sol[j]) discarded[n_discarded++] = j;
+      j = sr->order[p->n - 1 - r];
+      if (s->sol[j]) selected[n_selected++] = j;
+    }
+    int n_buckets = (((n_selected > n_discarded) ? n_selected : n_discarded) + half - 1) / half;
+
+    for (int b0 = 0 ; (b0 < n_buckets) && !improving && !finished(&timer) ; b0 += n_threads) {
+      // Build a batch of disjoint buckets
+      ks_batch batch;
+      batch.subproblems = subproblems;
+      batch.n_subproblems = 0;
+      batch.next = 0;
+      batch.time_limit = subproblem_time;
+      batch.sub_ctx = &sub_ctx;
+      // A time limit <= 0 would leave the subproblems unbounded
+      if (timer.active) {
+        float remaining = max_time - elapsed_time(&timer);
+        if (remaining <= 0) break;
+        if (remaining < subproblem_time) batch.time_limit = remaining;
+      }
+      for (int b = b0 ; (b < n_buckets) && (b < b0 + n_threads) ; b++) {
+        int n_free = 0;
+        for (int k = b * half ; (k < (b + 1) * half) && (k < n_selected) ; k++) {
+          items[n_free++] = selected[k];
+        }
+        for (int k = b * half ; (k < (b + 1) * half) && (k < n_discarded) ; k++) {
+          items[n_free++] = discarded[k];
+        }
+        subproblems[batch.n_subproblems++] = create_ks_subproblem(s, items, n_free, p);
+      }
+
+      // Solve the subproblems concurrently
+      for (int t = 1 ; t < batch.n_subproblems ; t++) {
+        pthread_create(&threads[t], NULL, ks_worker_run, &batch);
+      }
+      ks_worker_run(&batch);
+      for (int t = 1 ; t < batch.n_subproblems ; t++) {
+        pthread_join(threads[t], NULL);
+      }
+
+      // Buckets are disjoint: improvements can be combined
+      // as long as they keep the solution feasible
+      qsort(subproblems, batch.n_subproblems, sizeof(ks_subproblem *), ks_cmp_gain_decreasing);
+      for (int k = 0 ; k < batch.n_subproblems ; k++) {
+        if ((subproblems[k]->gain > 0) && ks_apply(s, subproblems[k], p)) improving = 1;
+        destroy_ks_subproblem(subproblems[k]);
+      }
+      if (improving) {
+        offer_elite(elite, s, p);
+        report_incumbent(ctx, s->value);
+      }
+    }
+  }
+
+  free(selected);
+  free(discarded);
+  free(items);
+  free(subproblems);
+  free(threads);
+  clear_search_context(&sub_ctx);
+  destroy_surrogate(sr);
+}
@@ -0,0 +1,105 @@
+/***************************************************************************
+ *   Copyright (C) 2018 Antoine Passemiers                                 *
+ *   apassemi@ulb.ac.be                                                    *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#ifndef __KERNEL_SEARCH_H__
+#define __KERNEL_SEARCH_H__
+
+#include <pthread.h>
+
+#include "mkpsolution.h"
+#include "mkpneighbourhood.h"
+#include "surrogate.h"
+#include "branch_and_bound.h"
+#include "elite.h"
+
+/*
+ * Restricted subproblem of the kernel search: the variables of a bucket
+ * are free, all other variables are fixed to their value in the incumbent.
+ *
+ * n_free         : number of free variables
+ * items          : vector of length n_free, items[k] is the item of the
+ *                  original instance corresponding to variable k
+ * sub            : MKP instance over the free variables, with capacities
+ *                  reduced by the resources used by the fixed variables
+ * initial        : incumbent restricted to the free variables
+ * result         : best solution of sub found by branch-and-bound
+ * gain           : result->value - initial->value
+ */
+typedef struct _ks_subproblem {
+  int n_free;
+  int *items;
+  problem *sub;
+  solution *initial;
+  solution *result;
+  int gain;
+} ks_subproblem;
+
+/*
+ * Build the subproblem where the given items are free and all other
+ * items are fixed to their value in s.
+ *
+ * s              : incumbent solution
+ * items          : free items (the vector is copied)
+ * n_free         : number of free items
+ * p              : instance of MKP
+ */
+ks_subproblem *create_ks_subproblem(const solution *s,
+                                    const int *items,
+                                    int n_free,
+                                    const problem *p);
+
+/*
+ * Deallocate a subproblem.
+ *
+ * ksp            : subproblem to deallocate
+ */
+void destroy_ks_subproblem(ks_subproblem *ksp);
+
+/*
+ * Improve a solution with kernel search (fix-and-optimize).
+ * Items are ranked by surrogate efficiency. Bucket b frees the b-th
+ * group of bucket_size / 2 least efficient selected items together with
+ * the b-th group of bucket_size / 2 most efficient discarded items, i.e.
+ * the variables whose values are the most likely to change. A batch of
+ * disjoint buckets is solved concurrently with branch-and-bound, each
+ * subproblem being capped at subproblem_time seconds. Improvements are
+ * then applied by decreasing gain as long as they remain feasible, and
+ * the buckets are rebuilt around the new incumbent until a full pass
+ * over the buckets brings no improvement.
+ *
+ * s               : initial feasible solution, improved in place
+ * p               : instance of MKP
+ * bucket_size     : number of free variables per subproblem
+ * subproblem_time : time limit of each subproblem
+ * n_threads       : number of subproblems solved concurrently
+ * max_time        : maximum execution time
+ * elite           : pool where improved solutions are offered (can be NULL)
+ * ctx             : context where new incumbents are reported (can be NULL)
+ */
+void kernel_search(solution *s,
+                   const problem *p,
+                   int bucket_size,
+                   float subproblem_time,
+                   int n_threads,
+                   float max_time,
+                   elite_pool *elite,
+                   search_context *ctx);
+
+#endif // __KERNEL_SEARCH_H__
@@ -27,73 +27,201 @@
 #include <time.h>
 #include <ctype.h>
 #include <unistd.h>
+#include <signal.h>
 
 #include "mkpdata.h"
 #include "utils.h"
+#include "cli.h"
 #include "mkpsolution.h"
 #include "mkpproblem.h"
-#include "mkpneighbourhood.h"
+#include "mkpsolver.h"
+#include "instance_stream.h"
+#include "output.h"
+#include "checkpoint.h"
 
-#include "constructive.h"
-#include "perturbative.h"
-#include "genetic.h"
-#include "annealing.h"
 
+// Set by SIGINT or SIGTERM: the search stops and its best solution is reported
+static cancel_token interrupted = 0;
+
+// Only sets the token (async-signal-safe). A second signal terminates
+// the process at once, as if no handler had been installed.
+static void interrupt_search(int sig) {
+  if (interrupted) {
+    signal(sig, SIG_DFL);
+    raise(sig);
+    return;
+  }
+  interrupted = 1;
+}
+
+static void install_interrupt_handlers(void) {
+  struct sigaction action;
+  memset(&action, 0x00, sizeof(struct sigaction));
+  action.sa_handler = interrupt_search;
+  sigemptyset(&action.sa_mask);
+  sigaction(SIGINT, &action, NULL);
+  sigaction(SIGTERM, &action, NULL);
+}
+
+// Whether the command runs the search that took a snapshot
+static int runs_phase(const mkp_options *opt, const char *phase) {
+  enum constructive h = (opt->h == BB) ? opt->bb_init : opt->h;
+  if (strcmp(phase, "ga") == 0) return(h == GA);
+  if (strcmp(phase, "sa") == 0) return(h == SA);
+  if (strcmp(phase, "vnd") == 0) return(opt->use_vns);
+  return(0);
+}
+
+// Solve one instance and report the solution
+static void solve_instance(mkp_solver *solver, problem *p, int index, const params *pars,
+                           const mkp_options *opt, progress_log *log, output_writer *out) {
+  // Print instance unless argument --terse is provided (text output only)
+  if (!pars->terse && (pars->format == TEXT_OUTPUT)) write_problem(out, p);
+
+  // New incumbents go to the progress log, if any
+  mkp_callbacks callbacks = {NULL, NULL};
+  if (log != NULL) {
+    start_progress_instance(log, index);
+    callbacks.on_incumbent = log_incumbent;
+    callbacks.user_data = log;
+  }
+  mkp_result result = mkp_solve(solver, p, opt, &callbacks);
+
+  // Display the items of the solution if argument --terse is not provided
+  // Otherwise display only execution time and value of the objective
+  run_report report;
+  report.index = index;
+  report.value = result.value;
+  report.feasible = result.feasible;
+  report.time = (float)result.time;
+  report.stats = result.has_stats ? &result.stats : NULL;
+  report.cancelled = result.cancelled;
+  write_report(out, pars->format, &report, result.s, pars->terse);
+  flush_output_writer(out);
+
+  destroy_solution(result.s);
+}
 
 int main(int argc, char *argv[]) {
   // Parse arguments. If they do not respect the expected form,
   // an error message is displayed and the program finishes.
   params *pars = read_params(argc, argv);
-  if (pars->has_parse_error) return(1);
+  if (pars->has_parse_error) {
+    print_usage();
+    free(pars);
+    return(1);
+  }
   
-  // Set seed with pars->seed if it has been provided,
+  // Seed the solver with pars->seed if it has been provided,
   // otherwise use current time.
-  if (pars->use_seed) set_seed(pars->seed);
-  else set_seed(time(NULL));
-  float max_time = pars->max_time;
-  
-  problem *p = read_problem(argv[1]);
-
-  // Print instance if argument --terse is provided
-  if (!pars->terse) print_problem(p);
-
-  clock_t start_time = clock();
-
-  // Find an initial solution using a constructive heuristic
-  solution *s;
-  if (pars->h == RANDOM) s = random_insertion(p);
-  else if (pars->h == GREEDY) s = greedy_insertion(p);
-  else if (pars->h == TOYODA) s = toyoda_algorithm(p);
-  else if (pars->h == SA) s = simulated_annealing(p, max_time);
-  else s = genetic_algorithm(p, max_time);
-
-  // If one the arguments [--fi, --bi, --vnd] is provided,
-  // improve the initial solution using the appropriate perturbative algorithm
-  if (pars->use_vns) {
-    if (pars->nm == VND) variable_neighbourhood_descent(s, p, pars->h, 3, max_time);
-  } else if (pars->use_nm){
-    improve_with_1_moves(s, p, pars->h, pars->nm, max_time);
+  mkp_solver *solver = create_mkp_solver(pars->use_seed ? pars->seed : (int)time(NULL));
+
+  progress_log *log = NULL;
+  if (pars->progress_file != NULL) {
+    log = open_progress_log(pars->progress_file);
+    if (log == NULL) {
+      fprintf(stderr, "error opening progress log %s\n", pars->progress_file);
+      destroy_mkp_solver(solver);
+      free(pars);
+      return(1);
+    }
   }
-  
-  // Measure execution time
-  clock_t end_time = clock();
-  float exec_time = (float)(end_time - start_time) / CLOCKS_PER_SEC;
 
-  // Display solution if argument --terse is not provided
-  // Otherwise display only execution time and value of the objective
-  printf("Solution value: %d\n", s->value);
-  if (is_feasible(s, p)) {
-    printf("Solution is feasible.\n");
-  } else {
-    printf("Solution is infeasible.\n");
+  // --resume gives either a checkpoint, or a solution to start from
+  snapshot *resume = NULL;
+  if (pars->resume_file != NULL) {
+    resume = read_snapshot(pars->resume_file);
+    if ((resume != NULL) && !runs_phase(&pars->options, resume->phase)) {
+      fprintf(stderr, "checkpoint %s was taken by %s, which is not run by this command\n",
+        pars->resume_file, resume->phase);
+      destroy_snapshot(resume);
+      if (log != NULL) close_progress_log(log);
+      destroy_mkp_solver(solver);
+      free(pars);
+      return(1);
+    }
+  }
+  checkpointer *checkpoint = NULL;
+  if (pars->checkpoint_file != NULL) {
+    checkpoint = create_checkpointer(pars->checkpoint_file, pars->checkpoint_interval);
   }
-  printf("Execution time in seconds: %.6f\n", exec_time);
-  if (!pars->terse) print_solution(s);
 
-  destroy_solution(s);
-  destroy_problem(p);
+  // All reports go through one buffered writer
+  output_writer *out = create_output_writer(stdout);
+  install_interrupt_handlers();
+  if (pars->format == TEXT_OUTPUT) write_format(out, "\nOpening instance file %s\n\n", argv[1]);
+
+  // Instances of the file are read and solved one at a time.
+  // When resuming, the instances solved before the checkpoint are skipped.
+  instance_stream *stream = open_instance_stream(argv[1]);
+  problem *p;
+  int error = 0;
+  while ((p = next_instance(stream)) != NULL) {
+    if ((resume != NULL) && (stream->index < resume->instance)) continue;
+
+    mkp_options opt = pars->options;
+    opt.checkpoint = checkpoint;
+    opt.cancel = &interrupted;
+    solution *warm_start = NULL;
+    if ((resume != NULL) && (stream->index == resume->instance)) {
+      opt.resume = resume;
+      if (resume->n != p->n) {
+        fprintf(stderr, "checkpoint %s does not match instance %d of %s\n",
+          pars->resume_file, stream->index, argv[1]);
+        error = 1;
+        break;
+      }
+    } else if ((pars->resume_file != NULL) && (resume == NULL) && (stream->index == 1)) {
+      // The warm start is a solution of the first instance
+      warm_start = read_solution_file(pars->resume_file, p);
+      if ((warm_start == NULL) || !is_feasible(warm_start, p)) {
+        fprintf(stderr, "%s holds no feasible solution of instance %d of %s\n",
+          pars->resume_file, stream->index, argv[1]);
+        if (warm_start != NULL) destroy_solution(warm_start);
+        error = 1;
+        break;
+      }
+      opt.warm_start = warm_start;
+    }
+
+    if ((stream->n_instances > 1) && (pars->format != JSON_OUTPUT)) {
+      write_format(out, "Instance %d of %d\n", stream->index, stream->n_instances);
+    }
+    start_checkpoint_instance(checkpoint, stream->index);
+    solve_instance(solver, p, stream->index, pars, &opt, log, out);
+    if (warm_start != NULL) destroy_solution(warm_start);
+
+    // The instances after an interrupted one are not solved
+    if (interrupted) {
+      if (stream->index < stream->n_instances) {
+        fprintf(stderr, "interrupted: instances %d to %d of %s were not solved\n",
+          stream->index + 1, stream->n_instances, argv[1]);
+        error = 1;
+      }
+      break;
+    }
+  }
+  if (stream->error) {
+    error = 1;
+    if (stream->file != NULL) {
+      fprintf(stderr, "error reading instance %d of %s\n", stream->index + 1, argv[1]);
+    }
+  } else if (!error && (resume != NULL) && (stream->index < resume->instance)) {
+    fprintf(stderr, "checkpoint %s is for instance %d, but %s has only %d\n",
+      pars->resume_file, resume->instance, argv[1], stream->index);
+    error = 1;
+  }
+  close_instance_stream(stream);
+  destroy_output_writer(out);
+  if ((checkpoint != NULL) && !destroy_checkpointer(checkpoint)) {
+    fprintf(stderr, "error writing checkpoint file %s\n", pars->checkpoint_file);
+    error = 1;
+  }
+  if (resume != NULL) destroy_snapshot(resume);
+  if (log != NULL) close_progress_log(log);
+  destroy_mkp_solver(solver);
   free(pars);
 
-  return(0);
+  return(error);
 }
 
@@ -31,13 +31,19 @@
  * TOYODA       : Toyoda algorithm (items sorted by pseudo-utilities)
  * SA           : Simulated Annealing
  * GA           : Genetic Algorithm
+ * BB           : Branch-and-Bound (exact)
+ * SDP          : Surrogate knapsack solved by dynamic programming, then repaired
+ * EDA          : Estimation-of-distribution algorithm (PBIL/UMDA)
  */
 enum constructive {
     RANDOM,
     GREEDY,
     TOYODA,
     SA,
-    GA
+    GA,
+    BB,
+    SDP,
+    EDA
 };
 
 /*
@@ -47,11 +53,102 @@ enum constructive {
  * FI           : First-Improvement
  * BI           : Best-Improvement
  * VND          : Variable Neighbourhood Descent
+ * KS           : Kernel Search (fix-and-optimize)
  */
 enum perturbative {
     FI,
     BI,
-    VND
+    VND,
+    KS
+};
+
+/*
+ * Passed to the branch-and-bound algorithm to inform it
+ * about which node selection strategy to use.
+ *
+ * DEPTH_FIRST  : Depth-first search, diving along the item order
+ * BEST_FIRST   : Open node with the highest bound first
+ */
+enum bb_strategy {
+    DEPTH_FIRST,
+    BEST_FIRST
+};
+
+/*
+ * Passed to SA and GA to inform them about when to improve
+ * new solutions with a 1-move local search.
+ *
+ * INTENSIFY_ALWAYS      : Every new solution (best-improvement)
+ * INTENSIFY_EVERY_K     : One new solution out of k
+ * INTENSIFY_PROBABILISTIC : Each new solution with a given probability
+ * INTENSIFY_NEAR_BEST   : New solutions within x% of the best solution
+ * INTENSIFY_FIRST_IMPROVEMENT : Every new solution, with first-improvement
+ * INTENSIFY_NEVER       : No local search
+ */
+enum intensification_mode {
+    INTENSIFY_ALWAYS,
+    INTENSIFY_EVERY_K,
+    INTENSIFY_PROBABILISTIC,
+    INTENSIFY_NEAR_BEST,
+    INTENSIFY_FIRST_IMPROVEMENT,
+    INTENSIFY_NEVER
+};
+
+/*
+ * Passed to simulated annealing to inform it about which
+ * cooling schedule to use.
+ *
+ * FIXED_COOLING    : Geometric cooling with fixed parameters
+ * ADAPTIVE_COOLING : Temperatures calibrated from sampled move deltas,
+ *                    cooling rate adapted to the time budget
+ */
+enum cooling {
+    FIXED_COOLING,
+    ADAPTIVE_COOLING
+};
+
+/*
+ * Passed to the repair engine to inform it about the order in which
+ * items are dropped (least useful first) and added (most useful first).
+ *
+ * REPAIR_DYNAMIC : Toyoda pseudo-utilities of the solution being repaired
+ * REPAIR_STATIC  : Pseudo-utilities computed once from the capacities
+ * REPAIR_RANDOM  : Random items are dropped, the ADD phase uses the
+ *                  static order
+ */
+enum repair_order {
+    REPAIR_DYNAMIC,
+    REPAIR_STATIC,
+    REPAIR_RANDOM
+};
+
+/*
+ * Passed to the estimation-of-distribution algorithm to inform it
+ * about how the model learns from the elites of each generation.
+ *
+ * PBIL           : Population-based incremental learning, probabilities
+ *                  move toward the elite frequencies at a learning rate
+ * UMDA           : Univariate marginal distribution algorithm,
+ *                  probabilities are the elite frequencies
+ */
+enum eda_model {
+    PBIL,
+    UMDA
+};
+
+/*
+ * Passed to the output layer to inform it about how to report solutions.
+ *
+ * TEXT_OUTPUT    : Human-readable text with the item lists
+ * JSON_OUTPUT    : One compact JSON object per instance
+ * HEX_OUTPUT     : Text summary with the bit-packed solution in hexadecimal
+ * BASE64_OUTPUT  : Text summary with the bit-packed solution in base64
+ */
+enum output_format {
+    TEXT_OUTPUT,
+    JSON_OUTPUT,
+    HEX_OUTPUT,
+    BASE64_OUTPUT
 };
 
 #endif // __MKPALGOTYPES_H__
\ No newline at end of file
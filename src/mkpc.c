@@ -0,0 +1,153 @@
+/***************************************************************************
+ *   Copyright (C) 2018 Antoine Passemiers                                 *
+ *   apassemi@ulb.ac.be                                                    *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+/*
+ * Client of the solver daemon (see mkpd.c): sends one instance with the
+ * options of mkp, then prints the incumbents as they are found and the
+ * final report. With --binary, the instance is converted to the binary
+ * layout before being sent. Exits with 2 if the request is rejected.
+ *
+ * Usage: mkpc <socket_path> <path_to_instance> <algorithm> [options]
+ *          [--binary] [--deadline value]
+ */
+
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "mkpdata.h"
+#include "utils.h"
+#include "instance_stream.h"
+
+// Maximum length of the options of a request
+#define MKPC_MAX_OPTIONS 4096
+
+
+// Load the instance as it is sent: the file itself, or its first
+// instance in the binary layout
+static char *load_instance(char *filename, int binary, size_t *size) {
+  char *data = NULL;
+  *size = 0;
+  if (binary) {
+    instance_stream *stream = open_instance_stream(filename);
+    problem *p = next_instance(stream);
+    if (p != NULL) {
+      FILE *memory = open_memstream(&data, size);
+      write_binary_instance(memory, p);
+      fclose(memory);
+    }
+    close_instance_stream(stream);
+    return(data);
+  }
+  FILE *file = fopen(filename, "r");
+  if (file == NULL) return(NULL);
+  FILE *memory = open_memstream(&data, size);
+  char buffer[65536];
+  size_t n_read;
+  while ((n_read = fread(buffer, 1, sizeof(buffer), file)) > 0) fwrite(buffer, 1, n_read, memory);
+  fclose(memory);
+  fclose(file);
+  return(data);
+}
+
+static int parse_error(void) {
+  printf("Usage: mkpc <socket_path> <path_to_instance> <algorithm> [options] \
+[--binary] [--deadline value]\n");
+  return(1);
+}
+
+int main(int argc, char *argv[]) {
+  if (argc < 4) return(parse_error());
+  int binary = 0;
+  double deadline = 0;
+  char options[MKPC_MAX_OPTIONS] = "";
+  size_t length = 0;
+  for (int i = 3 ; i < argc ; i++) {
+    if (strcmp(argv[i], "--binary") == 0) {
+      binary = 1;
+    } else if ((strcmp(argv[i], "--deadline") == 0) && (i + 1 < argc)) {
+      deadline = atof(argv[++i]);
+    } else {
+      // Other arguments are passed to the solver as they are
+      int written = snprintf(options + length, sizeof(options) - length, " %s", argv[i]);
+      if ((written < 0) || (length + written >= sizeof(options))) return(parse_error());
+      length += written;
+    }
+  }
+
+  size_t size;
+  char *data = load_instance(argv[2], binary, &size);
+  if ((data == NULL) || (size == 0)) {
+    fprintf(stderr, "error reading instance file %s\n", argv[2]);
+    free(data);
+    return(1);
+  }
+
+  struct sockaddr_un address;
+  memset(&address, 0x00, sizeof(address));
+  address.sun_family = AF_UNIX;
+  if (strlen(argv[1]) >= sizeof(address.sun_path)) {
+    fprintf(stderr, "socket path too long: %s\n", argv[1]);
+    free(data);
+    return(1);
+  }
+  strcpy(address.sun_path, argv[1]);
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if ((fd < 0) || (connect(fd, (struct sockaddr *)&address, sizeof(address)) < 0)) {
+    fprintf(stderr, "error connecting to %s\n", argv[1]);
+    free(data);
+    return(1);
+  }
+
+  // Request: header line, then the instance
+  FILE *out = fdopen(dup(fd), "w");
+  fprintf(out, "solve %s %zu %g%s\n", binary ? "binary" : "text", size, deadline, options);
+  fwrite(data, 1, size, out);
+  fclose(out);
+  shutdown(fd, SHUT_WR);
+  free(data);
+
+  // Reply: event lines, the report following the result line
+  FILE *in = fdopen(fd, "r");
+  char *line = NULL;
+  size_t line_size = 0;
+  int status = 1;
+  while (getline(&line, &line_size, in) > 0) {
+    size_t report_size;
+    if (sscanf(line, "result %zu", &report_size) == 1) {
+      char buffer[65536];
+      while (report_size > 0) {
+        size_t chunk = (report_size < sizeof(buffer)) ? report_size : sizeof(buffer);
+        size_t n_read = fread(buffer, 1, chunk, in);
+        if (n_read == 0) break;
+        fwrite(buffer, 1, n_read, stdout);
+        report_size -= n_read;
+      }
+      status = (report_size == 0) ? 0 : 1;
+    } else {
+      fputs(line, stdout);
+      if (strncmp(line, "rejected", 8) == 0) status = 2;
+    }
+    fflush(stdout);
+  }
+  free(line);
+  fclose(in);
+  return(status);
+}
@@ -0,0 +1,550 @@
+/***************************************************************************
+ *   Copyright (C) 2018 Antoine Passemiers                                 *
+ *   apassemi@ulb.ac.be                                                    *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+/*
+ * Solver daemon. Instances are sent on a Unix domain socket, one request
+ * per connection, and solved by a pool of worker threads that keep their
+ * solver (random generator, local-search workspace) and their problem
+ * buffer from one request to the next, so that small instances do not
+ * pay for process creation and allocations.
+ *
+ * Usage: mkpd <socket_path> [--workers value] [--queue value] [--seed value]
+ *
+ * Request: one header line, followed by the instance,
+ *   solve <text|binary> <size> <deadline> <algorithm> [options]
+ * where size is the number of bytes of the instance, in the text format
+ * of the instance files or in the binary layout of read_binary_instance,
+ * deadline is the number of seconds within which the result is expected
+ * (0 for none), and the algorithm and options are those of mkp.
+ *
+ * Reply: one line per event,
+ *   accepted
+ *   rejected <reason>
+ *   incumbent <value> <time>
+ *   result <size>      (followed by the report of mkp, in --format)
+ *   error <reason>
+ * A request is rejected when the queue is full, or when its deadline
+ * cannot be met: jobs are admitted only if the queued jobs, run in order
+ * on the first free workers, leave time for their whole budget (max-time
+ * times the number of timed phases). The check is repeated when a worker
+ * takes the job.
+ *
+ * Each request is read on its own thread, within MKPD_RECEIVE_TIMEOUT
+ * seconds, so that slow clients do not delay the others.
+ */
+
+#include <errno.h>
+#include <stdarg.h>
+#include <signal.h>
+#include <poll.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+
+#include "mkpdata.h"
+#include "utils.h"
+#include "cli.h"
+#include "mkpsolver.h"
+#include "instance_stream.h"
+#include "output.h"
+
+// Default number of worker threads
+#define MKPD_DEFAULT_WORKERS 1
+
+// Default maximum number of requests waiting for a worker
+#define MKPD_DEFAULT_QUEUE 64
+
+// Maximum length of a request header
+#define MKPD_MAX_HEADER 4096
+
+// Maximum number of options of a request
+#define MKPD_MAX_ARGS 128
+
+// Maximum size of an instance, in bytes
+#define MKPD_MAX_INSTANCE_SIZE (256 << 20)
+
+// Seconds allowed to a client to send its whole request
+#define MKPD_RECEIVE_TIMEOUT 10
+
+// Seconds a reply may wait for a client that does not read it
+#define MKPD_SEND_TIMEOUT 5
+
+// Maximum number of connections whose request is being read
+#define MKPD_MAX_READERS 64
+
+
+/*
+ * Request waiting for a worker, or being solved.
+ *
+ * out            : reply stream of the connection
+ * binary         : whether the instance is in the binary layout
+ * data           : instance, as sent by the client
+ * size           : number of bytes of data
+ * pars           : options of the request
+ * budget         : longest run time of the request (INFINITY if unbounded)
+ * deadline       : wall time at which the result is expected (0 for none)
+ * cancel         : set when the client is gone or does not read its
+ *                  replies, to stop the solve
+ * next           : next job in the queue
+ */
+typedef struct _job {
+  FILE *out;
+  int binary;
+  char *data;
+  size_t size;
+  params *pars;
+  double budget;
+  double deadline;
+  cancel_token cancel;
+  struct _job *next;
+} job;
+
+/*
+ * Jobs waiting for a worker, in order of arrival.
+ *
+ * lock           : protects the queue and busy_until
+ * ready          : signaled when a job is queued
+ * head, tail     : first and last jobs of the queue
+ * size           : number of queued jobs
+ * capacity       : maximum number of queued jobs
+ * n_workers      : number of workers
+ * busy_until     : wall time at which each worker is expected to be
+ *                  done with its current job (0 when idle)
+ * n_readers      : number of connections whose request is being read
+ *                  (updated atomically)
+ */
+typedef struct _job_queue {
+  pthread_mutex_t lock;
+  pthread_cond_t ready;
+  job *head;
+  job *tail;
+  int size;
+  int capacity;
+  int n_workers;
+  double *busy_until;
+  int n_readers;
+} job_queue;
+
+/*
+ * Worker thread, with the state it keeps between jobs.
+ *
+ * index          : index of the worker
+ * queue          : queue the jobs are taken from
+ * solver         : solver handle of the worker
+ * stream         : owner of the problem buffer of the worker
+ * thread         : thread running the worker
+ */
+typedef struct _worker {
+  int index;
+  job_queue *queue;
+  mkp_solver *solver;
+  instance_stream *stream;
+  pthread_t thread;
+} worker;
+
+/*
+ * Connection whose request is being read, on its own thread.
+ *
+ * fd             : socket of the connection
+ * queue          : queue the job is submitted to
+ * deadline       : wall time by which the whole request must be received
+ */
+typedef struct _reader {
+  int fd;
+  job_queue *queue;
+  double deadline;
+} reader;
+
+
+// Upper bound on the run time of a solve: each timed phase may take max_time
+static double job_budget(const mkp_options *opt) {
+  int n_phases = 0;
+  enum constructive h = opt->h;
+  if (h == BB) {
+    n_phases++;
+    h = opt->bb_init;
+  }
+  if ((h == SA) || (h == GA) || (h == EDA)) n_phases++;
+  n_phases += opt->use_nm + opt->use_vns + opt->use_ks + opt->use_path_relinking;
+  if (n_phases == 0) return(0.0);
+  return((opt->max_time > 0) ? n_phases * opt->max_time : INFINITY);
+}
+
+// Wall time at which a new job would start, if the queued jobs are taken
+// in order by the first free workers and last for their whole budget
+static double estimated_start(const job_queue *q, double now) {
+  double *free_at = (double *)malloc(q->n_workers * sizeof(double));
+  for (int w = 0 ; w < q->n_workers ; w++) {
+    free_at[w] = (q->busy_until[w] > now) ? q->busy_until[w] : now;
+  }
+  for (const job *j = q->head ; j != NULL ; j = j->next) {
+    int first = 0;
+    for (int w = 1 ; w < q->n_workers ; w++) if (free_at[w] < free_at[first]) first = w;
+    free_at[first] += j->budget;
+  }
+  double start = INFINITY;
+  for (int w = 0 ; w < q->n_workers ; w++) if (free_at[w] < start) start = free_at[w];
+  free(free_at);
+  return(start);
+}
+
+// Send a line to the client. Returns 0 if the connection is broken.
+static int reply(FILE *out, const char *format, ...) {
+  va_list args;
+  va_start(args, format);
+  int written = vfprintf(out, format, args);
+  va_end(args);
+  return((fflush(out) == 0) && (written >= 0));
+}
+
+static void destroy_job(job *j) {
+  fclose(j->out);
+  free(j->data);
+  free(j->pars);
+  free(j);
+}
+
+// Queue a job, unless the queue is full or its deadline cannot be met
+static void submit_job(job_queue *q, job *j) {
+  pthread_mutex_lock(&q->lock);
+  double now = wall_time();
+  if (q->size >= q->capacity) {
+    pthread_mutex_unlock(&q->lock);
+    reply(j->out, "rejected queue full\n");
+    destroy_job(j);
+    return;
+  }
+  double finish = estimated_start(q, now) + j->budget;
+  if ((j->deadline > 0) && (finish > j->deadline)) {
+    pthread_mutex_unlock(&q->lock);
+    if (isinf(finish)) reply(j->out, "rejected deadline unbounded run time\n");
+    else reply(j->out, "rejected deadline expected in %.3f s\n", finish - now);
+    destroy_job(j);
+    return;
+  }
+  j->next = NULL;
+  if (q->tail == NULL) q->head = j;
+  else q->tail->next = j;
+  q->tail = j;
+  q->size++;
+  reply(j->out, "accepted\n");
+  pthread_cond_signal(&q->ready);
+  pthread_mutex_unlock(&q->lock);
+}
+
+// Send each incumbent to the client as soon as it is found.
+// The solve is cancelled once the client cannot receive them: sends
+// fail after MKPD_SEND_TIMEOUT seconds when the client stops reading.
+static void stream_incumbent(void *user_data, int value, double time) {
+  job *j = (job *)user_data;
+  if (j->cancel) return;
+  if (!reply(j->out, "incumbent %d %.6f\n", value, time)) j->cancel = 1;
+}
+
+static void run_job(worker *w, job *j) {
+  // The instance is parsed into the problem buffer of the worker
+  const problem *p = NULL;
+  if (j->binary) {
+    if (j->size % sizeof(int32_t) == 0) {
+      p = read_binary_instance(w->stream, (const int32_t *)j->data, j->size / sizeof(int32_t));
+    }
+  } else {
+    FILE *file = fmemopen(j->data, j->size, "r");
+    if ((file != NULL) && reopen_instance_stream(w->stream, file)) p = next_instance(w->stream);
+    // The data of the job is freed after the job
+    if (w->stream->file != NULL) fclose(w->stream->file);
+    w->stream->file = NULL;
+  }
+  if (p == NULL) {
+    reply(j->out, "error malformed instance\n");
+    return;
+  }
+
+  if (j->pars->use_seed) seed_mkp_solver(w->solver, j->pars->seed);
+  mkp_callbacks callbacks = {stream_incumbent, j};
+  j->pars->options.cancel = &j->cancel;
+  mkp_result result = mkp_solve(w->solver, p, &j->pars->options, &callbacks);
+  if (j->cancel) {
+    // The client is gone: the report would not be read
+    destroy_solution(result.s);
+    return;
+  }
+
+  // The report is rendered in memory to send its size first
+  char *buffer = NULL;
+  size_t size = 0;
+  FILE *memory = open_memstream(&buffer, &size);
+  output_writer *report_writer = create_output_writer(memory);
+  run_report report;
+  report.index = 1;
+  report.value = result.value;
+  report.feasible = result.feasible;
+  report.time = result.time;
+  report.stats = result.has_stats ? &result.stats : NULL;
+  report.cancelled = result.cancelled;
+  write_report(report_writer, j->pars->format, &report, result.s, j->pars->terse);
+  destroy_output_writer(report_writer);
+  fclose(memory);
+  fprintf(j->out, "result %zu\n", size);
+  fwrite(buffer, 1, size, j->out);
+  fflush(j->out);
+  free(buffer);
+  destroy_solution(result.s);
+}
+
+static void *worker_run(void *arg) {
+  worker *w = (worker *)arg;
+  job_queue *q = w->queue;
+  while (1) {
+    pthread_mutex_lock(&q->lock);
+    while (q->head == NULL) pthread_cond_wait(&q->ready, &q->lock);
+    job *j = q->head;
+    q->head = j->next;
+    if (q->head == NULL) q->tail = NULL;
+    q->size--;
+    double now = wall_time();
+    q->busy_until[w->index] = now + j->budget;
+    pthread_mutex_unlock(&q->lock);
+
+    // Jobs may have waited longer than expected
+    if ((j->deadline > 0) && (now + j->budget > j->deadline)) {
+      reply(j->out, "rejected deadline expired in queue\n");
+    } else {
+      run_job(w, j);
+    }
+    destroy_job(j);
+
+    pthread_mutex_lock(&q->lock);
+    q->busy_until[w->index] = 0;
+    pthread_mutex_unlock(&q->lock);
+  }
+  return(NULL);
+}
+
+// Receive at most size bytes, waiting until the deadline (wall time).
+// Returns the number of bytes received, 0 if the connection is closed,
+// -1 on error or when the deadline has passed.
+static ssize_t receive_some(int fd, char *buffer, size_t size, double deadline) {
+  while (1) {
+    double left = deadline - wall_time();
+    if (left <= 0) return(-1);
+    struct pollfd pfd = {fd, POLLIN, 0};
+    int ready = poll(&pfd, 1, (int)(left * 1000) + 1);
+    if ((ready < 0) && (errno == EINTR)) continue;
+    if (ready <= 0) return(-1);
+    ssize_t n = recv(fd, buffer, size, 0);
+    if ((n < 0) && (errno == EINTR)) continue;
+    return(n);
+  }
+}
+
+// Read the request of a new connection before the deadline. Returns NULL,
+// after replying to the client, if the request is malformed or late.
+static job *read_request(int fd, double request_deadline) {
+  FILE *out = fdopen(fd, "w");
+  job *j = (job *)calloc(1, sizeof(job));
+  j->out = out;
+  const char *error = NULL;
+  char *argv[MKPD_MAX_ARGS + 2];
+  int argc = 0;
+  char format[16];
+  unsigned long long size;
+  double deadline;
+  int header_length = 0;
+
+  // The header is read into a fixed buffer, which may also receive
+  // the first bytes of the instance
+  char line[MKPD_MAX_HEADER + 1];
+  size_t n_read = 0;
+  char *newline = NULL;
+  ssize_t n = 1;
+  while ((newline == NULL) && (n_read < MKPD_MAX_HEADER)) {
+    n = receive_some(fd, line + n_read, MKPD_MAX_HEADER - n_read, request_deadline);
+    if (n <= 0) break;
+    newline = (char *)memchr(line + n_read, '\n', n);
+    n_read += n;
+  }
+  if (newline == NULL) {
+    error = (n < 0) ? "request timed out" : "malformed header";
+  } else {
+    *newline = '\0';
+    if ((sscanf(line, "solve %15s %llu %lf %n", format, &size, &deadline,
+                &header_length) < 3) || (header_length == 0)) {
+      error = "malformed header";
+    } else if ((strcmp(format, "text") != 0) && (strcmp(format, "binary") != 0)) {
+      error = "unknown instance format";
+    } else if ((size == 0) || (size > MKPD_MAX_INSTANCE_SIZE)) {
+      error = "instance too large";
+    }
+  }
+
+  // Options are parsed as mkp arguments, without instance file
+  if (error == NULL) {
+    argv[argc++] = "mkpd";
+    argv[argc++] = "-";
+    char *saveptr = NULL;
+    for (char *token = strtok_r(line + header_length, " \t\r", &saveptr) ;
+         (token != NULL) && (argc < MKPD_MAX_ARGS + 2) ;
+         token = strtok_r(NULL, " \t\r", &saveptr)) {
+      argv[argc++] = token;
+    }
+    j->pars = read_params(argc, argv);
+    if (j->pars->has_parse_error) {
+      error = "invalid options";
+    } else if ((j->pars->progress_file != NULL) || (j->pars->checkpoint_file != NULL) || \
+               (j->pars->resume_file != NULL)) {
+      error = "file options are not supported";
+    }
+  }
+
+  if (error == NULL) {
+    j->binary = (strcmp(format, "binary") == 0);
+    j->size = (size_t)size;
+    j->data = (char *)malloc(j->size);
+    size_t received = n_read - (size_t)(newline + 1 - line);
+    if (received > j->size) received = j->size;
+    memcpy(j->data, newline + 1, received);
+    while ((received < j->size) && \
+           ((n = receive_some(fd, j->data + received, j->size - received, request_deadline)) > 0)) {
+      received += n;
+    }
+    if (received < j->size) error = (n < 0) ? "request timed out" : "truncated instance";
+  }
+  if (error != NULL) {
+    reply(out, "error %s\n", error);
+    destroy_job(j);
+    return(NULL);
+  }
+  j->budget = job_budget(&j->pars->options);
+  j->deadline = (deadline > 0) ? (wall_time() + deadline) : 0;
+  return(j);
+}
+
+// Read one request and submit its job, on the thread of the connection
+static void *reader_run(void *arg) {
+  reader *r = (reader *)arg;
+  job *j = read_request(r->fd, r->deadline);
+  if (j != NULL) submit_job(r->queue, j);
+  __atomic_sub_fetch(&r->queue->n_readers, 1, __ATOMIC_ACQ_REL);
+  free(r);
+  return(NULL);
+}
+
+// Hand a new connection to a reader thread, unless too many are reading
+static void start_reader(job_queue *q, int fd) {
+  static const char busy[] = "rejected too many connections\n";
+  if (__atomic_add_fetch(&q->n_readers, 1, __ATOMIC_ACQ_REL) > MKPD_MAX_READERS) {
+    __atomic_sub_fetch(&q->n_readers, 1, __ATOMIC_ACQ_REL);
+    // The accept thread does not wait for the client
+    send(fd, busy, sizeof(busy) - 1, MSG_DONTWAIT);
+    close(fd);
+    return;
+  }
+  reader *r = (reader *)malloc(sizeof(reader));
+  r->fd = fd;
+  r->queue = q;
+  r->deadline = wall_time() + MKPD_RECEIVE_TIMEOUT;
+  pthread_t thread;
+  if (pthread_create(&thread, NULL, reader_run, r) != 0) {
+    __atomic_sub_fetch(&q->n_readers, 1, __ATOMIC_ACQ_REL);
+    close(fd);
+    free(r);
+    return;
+  }
+  pthread_detach(thread);
+}
+
+static int parse_error(void) {
+  printf("Usage: mkpd <socket_path> [--workers value] [--queue value] [--seed value]\n");
+  return(1);
+}
+
+int main(int argc, char *argv[]) {
+  if (argc < 2) return(parse_error());
+  int n_workers = MKPD_DEFAULT_WORKERS;
+  int capacity = MKPD_DEFAULT_QUEUE;
+  int seed = (int)time(NULL);
+  for (int i = 2 ; i < argc ; i++) {
+    if ((strcmp(argv[i], "--workers") == 0) && (i + 1 < argc)) n_workers = atoi(argv[++i]);
+    else if ((strcmp(argv[i], "--queue") == 0) && (i + 1 < argc)) capacity = atoi(argv[++i]);
+    else if ((strcmp(argv[i], "--seed") == 0) && (i + 1 < argc)) seed = atoi(argv[++i]);
+    else return(parse_error());
+  }
+  if ((n_workers < 1) || (capacity < 0)) return(parse_error());
+
+  // Clients that disconnect must not kill the daemon
+  signal(SIGPIPE, SIG_IGN);
+
+  struct sockaddr_un address;
+  memset(&address, 0x00, sizeof(address));
+  address.sun_family = AF_UNIX;
+  if (strlen(argv[1]) >= sizeof(address.sun_path)) {
+    fprintf(stderr, "socket path too long: %s\n", argv[1]);
+    return(1);
+  }
+  strcpy(address.sun_path, argv[1]);
+  int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+  unlink(argv[1]);
+  if ((listener < 0) || (bind(listener, (struct sockaddr *)&address, sizeof(address)) < 0) || \
+      (listen(listener, SOMAXCONN) < 0)) {
+    fprintf(stderr, "error listening on %s: %s\n", argv[1], strerror(errno));
+    return(1);
+  }
+
+  job_queue queue;
+  pthread_mutex_init(&queue.lock, NULL);
+  pthread_cond_init(&queue.ready, NULL);
+  queue.head = queue.tail = NULL;
+  queue.size = 0;
+  queue.capacity = capacity;
+  queue.n_workers = n_workers;
+  queue.busy_until = (double *)calloc(n_workers, sizeof(double));
+  queue.n_readers = 0;
+
+  // Each worker has its own solver, seeded from the seed of the daemon
+  worker *workers = (worker *)malloc(n_workers * sizeof(worker));
+  for (int w = 0 ; w < n_workers ; w++) {
+    workers[w].index = w;
+    workers[w].queue = &queue;
+    workers[w].solver = create_mkp_solver(seed + w);
+    workers[w].stream = create_instance_stream();
+    pthread_create(&workers[w].thread, NULL, worker_run, &workers[w]);
+  }
+  printf("mkpd listening on %s with %d workers\n", argv[1], n_workers);
+  fflush(stdout);
+
+  while (1) {
+    int fd = accept(listener, NULL, NULL);
+    if (fd < 0) {
+      if (errno == EINTR) continue;
+      fprintf(stderr, "error accepting connection: %s\n", strerror(errno));
+      break;
+    }
+    // Replies never block a worker for long (see stream_incumbent)
+    struct timeval timeout = {MKPD_SEND_TIMEOUT, 0};
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+    start_reader(&queue, fd);
+  }
+  close(listener);
+  unlink(argv[1]);
+  return(1);
+}
@@ -28,6 +28,8 @@
 #include <string.h>
 #include <stdlib.h>
 #include <time.h>
+#include <stdint.h>
+#include <signal.h>
 
 #include "mkpalgotypes.h"
 
@@ -40,6 +42,10 @@
  * sol            : 0/1 vector (item j discarded/selected)
  * resources_used : vector of length m containing the amount of resources used
  *                  by the current solution
+ * hash           : Zobrist hash of sol (XOR of the keys of the selected items),
+ *                  maintained incrementally when items are added or removed
+ * bits           : sol packed in 64-bit words (item j is bit j % 64 of
+ *                  word j / 64), maintained along with sol
  */
 typedef struct _solution {
   int n;
@@ -47,36 +53,183 @@ typedef struct _solution {
   int value;
   int *sol;
   int *resources_used;
+  uint64_t hash;
+  uint64_t *bits;
 } solution;
 
+// number of 64-bit words needed to store a bitset of n items
+#define N_WORDS(n) (((n) + 63) / 64)
+
 
 /*
- * storage for command-line parameters and supplementary information
- * 
- * instance_file   : path to the instance file
+ * policy deciding when SA and GA improve new solutions with local search
+ *
+ * mode            : when to apply the local search (see mkpalgotypes.h)
+ * every_k         : period of INTENSIFY_EVERY_K
+ * probability     : probability of INTENSIFY_PROBABILISTIC
+ * within          : relative distance to the best value below which
+ *                   INTENSIFY_NEAR_BEST applies the local search (0.01 = 1%)
+ * max_moves       : maximum number of improving moves per local search
+ *                   (0 for no limit)
+ * max_time        : time budget of each local search (<= 0 for no limit)
+ * n_steps         : number of solutions submitted to the policy so far
+ */
+typedef struct _intensification {
+  enum intensification_mode mode;
+  int every_k;
+  float probability;
+  float within;
+  int max_moves;
+  float max_time;
+  long long n_steps;
+} intensification;
+
+
+/*
+ * settings of the genetic algorithm
+ *
+ * population_size : number of members of the population
+ * mutation_rate   : number of items flipped in each child
+ * tournament_size : number of members competing to become a parent
+ * repair_order    : order in which infeasible children drop and add items
+ */
+typedef struct _ga_config {
+  int population_size;
+  int mutation_rate;
+  int tournament_size;
+  enum repair_order repair_order;
+} ga_config;
+
+/*
+ * settings of simulated annealing
+ *
+ * cooling         : FIXED_COOLING or ADAPTIVE_COOLING
+ * reheat          : whether to reheat the system on stagnation
+ *                   (ADAPTIVE_COOLING only)
+ * t0              : initial temperature (FIXED_COOLING only)
+ * alpha           : cooling rate (FIXED_COOLING only)
+ * t_frozen        : temperature at which the system is frozen
+ *                   (FIXED_COOLING only)
+ */
+typedef struct _sa_config {
+  enum cooling cooling;
+  int reheat;
+  float t0;
+  float alpha;
+  double t_frozen;
+} sa_config;
+
+/*
+ * settings of the estimation-of-distribution algorithm
+ *
+ * model           : PBIL or UMDA
+ * population_size : number of individuals sampled per generation
+ * n_elites        : number of best individuals the model learns from
+ * learning_rate   : weight of the elite frequencies in the PBIL update
+ * repair_order    : order in which infeasible samples drop and add items
+ */
+typedef struct _eda_config {
+  enum eda_model model;
+  int population_size;
+  int n_elites;
+  float learning_rate;
+  enum repair_order repair_order;
+} eda_config;
+
+
+struct _checkpointer;
+struct _snapshot;
+
+/*
+ * Cancellation token: a search watching it stops as if its time were up
+ * once it is set to a nonzero value, from any thread or from a signal
+ * handler.
+ */
+typedef volatile sig_atomic_t cancel_token;
+
+/*
+ * Settings of one resolution with mkp_solve (see mkpsolver.h)
+ *
  * h               : Type of constructive heuristic to use
  * nm              : Type of perturbative algorithm to use (if use_nm is set to true)
  * use_nm          : Whether to use best-improvement or best-improvement algorithm
  * use_vns         : Whether to use Variable Neighbourhood Descent (VND) or
  *                   Relaxation-Guided Variable Neighbourhood Search (RGVNS).
- *                   use_nm and use_vnd cannot be both true but can be both false
+ * use_ks          : Whether to use Kernel Search.
+ *                   At most one of use_nm, use_vns and use_ks can be true
+ * max_time        : Maximum execution time for local search algorithms
+ * bb_init         : Heuristic providing the first incumbent of branch-and-bound
+ * bb_strategy     : Node selection strategy of branch-and-bound
+ * n_threads       : Number of threads used by parallel algorithms
+ * use_path_relinking : Whether to run path relinking between elite solutions
+ *                   as a post-optimization phase
+ * elite_size      : Maximum number of solutions in the elite pool
+ * ks_bucket_size  : Number of free variables per kernel search subproblem
+ * ks_time         : Time limit of each kernel search subproblem
+ * intensify       : Local search policy of SA and GA
+ * ga              : Settings of GA
+ * sa              : Settings of SA
+ * eda             : Settings of the EDA
+ * checkpoint      : Where GA, SA and VND take snapshots (NULL if none)
+ * resume          : Snapshot of the search to continue (NULL if none)
+ * warm_start      : Solution to start from (NULL if none), repaired
+ *                   first if it is infeasible
+ * cancel          : Token stopping the search when set (NULL if none)
+ * share_incumbents : Whether GA, SA and VND exchange incumbents with the
+ *                   other processes solving the same instance
+ */
+typedef struct _mkp_options {
+  enum constructive h;
+  enum perturbative nm;
+  int use_nm;
+  int use_vns;
+  int use_ks;
+  float max_time;
+  enum constructive bb_init;
+  enum bb_strategy bb_strategy;
+  int n_threads;
+  int use_path_relinking;
+  int elite_size;
+  int ks_bucket_size;
+  float ks_time;
+  intensification intensify;
+  ga_config ga;
+  sa_config sa;
+  eda_config eda;
+  struct _checkpointer *checkpoint;
+  const struct _snapshot *resume;
+  const solution *warm_start;
+  const cancel_token *cancel;
+  int share_incumbents;
+} mkp_options;
+
+/*
+ * storage for command-line parameters and supplementary information
+ * 
+ * instance_file   : path to the instance file
+ * options         : Settings of the algorithms
  * use_seed        : Whether to use a seed (set to true if argument --seed is provided)
  * seed            : Value of the seed for the RNG
  * terse           : Whether to print brief messages to the standard output
  *                   If set to true, only execution time and value of the objective will be printed
- * max_time        : Maximum execution time for local search algorithms
+ * format          : Format of the solution reports
+ * progress_file   : Path to the JSON-lines log of incumbents (NULL if none)
+ * checkpoint_file : Path to the snapshots of GA, SA and VND (NULL if none)
+ * checkpoint_interval : Minimum number of seconds between two snapshots
+ * resume_file     : Checkpoint or solution file to start from (NULL if none)
  * has_parse_error : Whether the command-line parser failed
  */
 typedef struct _params {
   char *instance_file;
-  enum constructive h;
-  enum perturbative nm;
-  int use_nm;
-  int use_vns;
+  mkp_options options;
   int use_seed;
   int seed;
   int terse;
-  float max_time;
+  enum output_format format;
+  char *progress_file;
+  char *checkpoint_file;
+  float checkpoint_interval;
+  char *resume_file;
   int has_parse_error;
 } params;
 
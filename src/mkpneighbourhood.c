@@ -26,10 +26,26 @@ void add_item(solution *s, int item, const problem *p) {
   if (s->sol[item] == 0) {
     s->sol[item] = 1;
     s->value += p->profits[item]; // delta evaluation
+    s->hash ^= p->zobrist[item];
+    s->bits[item / 64] |= (1ULL << (item % 64));
 
     // update list of resources used by the current solution
+    if (p->sparse) {
+      for (int k = p->nz_start[item] ; k < p->nz_start[item + 1] ; k++) {
+        s->resources_used[p->nz_rows[k]] += p->nz_weights[k];
+      }
+      return;
+    }
+    if (p->weights16 != NULL) {
+      const int16_t *w = p->weights16 + (size_t)item * p->m;
+      for (int i = 0 ; i < s->m ; i++) {
+        s->resources_used[i] += w[i];
+      }
+      return;
+    }
+    const int *w = p->weights + (size_t)item * p->m;
     for (int i = 0 ; i < s->m ; i++) {
-      s->resources_used[i] += p->constraints[i][item];
+      s->resources_used[i] += w[i];
     }
   }
 }
@@ -38,8 +54,23 @@ int check_item(solution *s, int item, const problem *p) {
   // check whether adding the item would lead to violate some contraints
   // and count how many
   if (s->sol[item] == 1) return(1);
+  if (p->sparse) {
+    for (int k = p->nz_start[item] ; k < p->nz_start[item + 1] ; k++) {
+      int i = p->nz_rows[k];
+      if (s->resources_used[i] + p->nz_weights[k] > p->capacities[i]) return(1);
+    }
+    return(0);
+  }
+  if (p->weights16 != NULL) {
+    const int16_t *w = p->weights16 + (size_t)item * p->m;
+    for (int i = 0 ; i < s->m ; i++) {
+      if (s->resources_used[i] + w[i] > p->capacities[i]) return(1);
+    }
+    return(0);
+  }
+  const int *w = p->weights + (size_t)item * p->m;
   for (int i = 0 ; i < s->m ; i++) {
-    if (s->resources_used[i] + p->constraints[i][item] > p->capacities[i]) {
+    if (s->resources_used[i] + w[i] > p->capacities[i]) {
       return(1);
     }
   }
@@ -61,10 +92,76 @@ void remove_item(solution *s, int item, const problem *p) {
   if (s->sol[item] == 1) {
     s->sol[item] = 0;
     s->value -= p->profits[item]; // delta evaluation
+    s->hash ^= p->zobrist[item];
+    s->bits[item / 64] &= ~(1ULL << (item % 64));
 
     // update list of resources used by the current solution
+    if (p->sparse) {
+      for (int k = p->nz_start[item] ; k < p->nz_start[item + 1] ; k++) {
+        s->resources_used[p->nz_rows[k]] -= p->nz_weights[k];
+      }
+      return;
+    }
+    if (p->weights16 != NULL) {
+      const int16_t *w = p->weights16 + (size_t)item * p->m;
+      for (int i = 0 ; i < s->m ; i++) {
+        s->resources_used[i] -= w[i];
+      }
+      return;
+    }
+    const int *w = p->weights + (size_t)item * p->m;
     for (int i = 0 ; i < s->m ; i++) {
-      s->resources_used[i] -= p->constraints[i][item];
+      s->resources_used[i] -= w[i];
+    }
+  }
+}
+
+undo_log *create_undo_log(int capacity) {
+  undo_log *undo = (undo_log *)malloc(sizeof(undo_log));
+  undo->size = 0;
+  undo->capacity = (capacity > 0) ? capacity : 1;
+  undo->items = (int *)malloc(undo->capacity * sizeof(int));
+  return(undo);
+}
+
+static void push_flip(undo_log *undo, int item) {
+  if (undo->size == undo->capacity) {
+    undo->capacity *= 2;
+    undo->items = (int *)realloc(undo->items, undo->capacity * sizeof(int));
+  }
+  undo->items[undo->size++] = item;
+}
+
+void flip_item(solution *s, int item, undo_log *undo, const problem *p) {
+  if (s->sol[item]) remove_item(s, item, p);
+  else add_item(s, item, p);
+  push_flip(undo, item);
+}
+
+void log_differences(const solution *s, const uint64_t *before, undo_log *undo) {
+  for (int w = 0 ; w < N_WORDS(s->n) ; w++) {
+    uint64_t diff = s->bits[w] ^ before[w];
+    while (diff) {
+      push_flip(undo, 64 * w + __builtin_ctzll(diff));
+      diff &= diff - 1;
     }
   }
-}
\ No newline at end of file
+}
+
+void undo_flips(solution *s, undo_log *undo, const problem *p) {
+  for (int k = undo->size - 1 ; k >= 0 ; k--) {
+    int item = undo->items[k];
+    if (s->sol[item]) remove_item(s, item, p);
+    else add_item(s, item, p);
+  }
+  undo->size = 0;
+}
+
+void commit_flips(undo_log *undo) {
+  undo->size = 0;
+}
+
+void destroy_undo_log(undo_log *undo) {
+  if (undo->items != NULL) free(undo->items);
+  free(undo);
+}
@@ -53,4 +53,38 @@ int check_and_add_item(solution *s, int item, const problem *p);
 // Remove item from solution (no need for feasability check)
 void remove_item(solution *s, int item, const problem *p);
 
+/*
+ * Log of the items flipped since the last committed state of a solution.
+ * Moves are undone by flipping the logged items back in reverse order,
+ * so that a rejected move costs O(m) per flipped item instead of
+ * a full copy of the solution.
+ *
+ * size           : number of logged flips
+ * capacity       : allocated length of items
+ * items          : flipped items, in chronological order
+ */
+typedef struct _undo_log {
+  int size;
+  int capacity;
+  int *items;
+} undo_log;
+
+// Create an empty undo log
+undo_log *create_undo_log(int capacity);
+
+// Flip item in the solution (add or remove it) and log the flip
+void flip_item(solution *s, int item, undo_log *undo, const problem *p);
+
+// Log the items on which s differs from the bitset before
+void log_differences(const solution *s, const uint64_t *before, undo_log *undo);
+
+// Undo all logged flips and clear the log
+void undo_flips(solution *s, undo_log *undo, const problem *p);
+
+// Keep the current state of the solution and clear the log
+void commit_flips(undo_log *undo);
+
+// Deallocate undo log
+void destroy_undo_log(undo_log *undo);
+
 #endif // __MKPNEIGHBOURHOOD_H__
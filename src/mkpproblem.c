@@ -19,6 +19,7 @@
  ***************************************************************************/
 
 #include "mkpproblem.h"
+#include "output.h"
 
 problem *create_problem(int n,
                         int m,
@@ -33,39 +34,102 @@ problem *create_problem(int n,
   p->profits = profits;
   p->constraints = constraints;
   p->capacities = capacities;
+  create_item_major_weights(p);
+  create_zobrist_keys(p);
   return (p);
 }
 
+void create_item_major_weights(problem *p) {
+  size_t nnz = 0;
+  for (int i = 0 ; i < p->m ; i++) {
+    for (int j = 0 ; j < p->n ; j++) nnz += (p->constraints[i][j] != 0);
+  }
+  p->sparse = (nnz <= SPARSE_DENSITY * p->n * p->m);
+  p->weights = NULL;
+  p->weights16 = NULL;
+  p->nz_start = p->nz_rows = p->nz_weights = NULL;
+  if (!p->sparse) {
+    int narrow = 1;
+    for (int i = 0 ; narrow && (i < p->m) ; i++) {
+      for (int j = 0 ; narrow && (j < p->n) ; j++) {
+        narrow = (p->constraints[i][j] >= INT16_MIN) && (p->constraints[i][j] <= INT16_MAX);
+      }
+    }
+    if (narrow) p->weights16 = (int16_t *)malloc((size_t)p->n * p->m * sizeof(int16_t));
+    else p->weights = (int *)malloc((size_t)p->n * p->m * sizeof(int));
+    for (int i = 0 ; i < p->m ; i++) {
+      for (int j = 0 ; j < p->n ; j++) {
+        if (narrow) p->weights16[(size_t)j * p->m + i] = (int16_t)p->constraints[i][j];
+        else p->weights[(size_t)j * p->m + i] = p->constraints[i][j];
+      }
+    }
+    return;
+  }
+
+  // Compressed sparse columns: the nonzeros of each item are contiguous
+  p->nz_start = (int *)malloc((p->n + 1) * sizeof(int));
+  p->nz_rows = (int *)malloc((nnz > 0 ? nnz : 1) * sizeof(int));
+  p->nz_weights = (int *)malloc((nnz > 0 ? nnz : 1) * sizeof(int));
+  int k = 0;
+  for (int j = 0 ; j < p->n ; j++) {
+    p->nz_start[j] = k;
+    for (int i = 0 ; i < p->m ; i++) {
+      if (p->constraints[i][j] != 0) {
+        p->nz_rows[k] = i;
+        p->nz_weights[k++] = p->constraints[i][j];
+      }
+    }
+  }
+  p->nz_start[p->n] = k;
+}
+
+void destroy_item_major_weights(problem *p) {
+  free(p->weights);
+  free(p->weights16);
+  free(p->nz_start);
+  free(p->nz_rows);
+  free(p->nz_weights);
+}
+
+uint64_t zobrist_key(int item) {
+  // Output of a SplitMix64 generator with a fixed seed, jumped ahead
+  uint64_t z = 0x9E3779B97F4A7C15ULL * (uint64_t)(item + 2);
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+  return(z ^ (z >> 31));
+}
+
+void create_zobrist_keys(problem *p) {
+  p->zobrist = (uint64_t *)malloc(p->n * sizeof(uint64_t));
+  for (int j = 0 ; j < p->n ; j++) p->zobrist[j] = zobrist_key(j);
+}
+
+int fits_in_int(const problem *p) {
+  int64_t total = 0;
+  for (int j = 0 ; j < p->n ; j++) total += llabs(p->profits[j]);
+  if (total > INT_MAX) return(0);
+  for (int i = 0 ; i < p->m ; i++) {
+    total = llabs(p->capacities[i]);
+    for (int j = 0 ; j < p->n ; j++) total += llabs(p->constraints[i][j]);
+    if (total > INT_MAX) return(0);
+  }
+  return(1);
+}
+
 void destroy_problem(problem *p) {
   free(p->profits);
   for (int i = 0 ; i < p->m ; i++) free(p->constraints[i]);
   free(p->constraints);
+  destroy_item_major_weights(p);
   free(p->capacities);
+  free(p->zobrist);
   free(p);
 }
 
 void print_problem(problem *p) {
-  int i, j;
-
-  printf("Problem data:\n");
-  printf("%d objects, %d knapsacks", p->n, p->m);
-  if (p->best_known != 0) printf(", best known value: %d", p->best_known);
-  printf("\n\n");
-
-  printf("Object profits:\n");
-  for (i = 0 ; i < p->n ; i++) {
-    printf("%d ", p->profits[i]);
-  }
-  printf("\n\n");
-
-  printf("Constraint matrix:\n");
-  for (i = 0 ; i < p->m ; i++) {
-    for (j = 0 ; j < p->n - 1 ; j++) {
-      printf("%d * x%d + ", p->constraints[i][j], j);
-    }
-    printf("%d * x%d <= %d\n", p->constraints[i][p->n - 1],  p->n - 1, p->capacities[i]);
-  }
-  printf("\n");
+  output_writer *w = create_output_writer(stdout);
+  write_problem(w, p);
+  destroy_output_writer(w);
 }
 
 problem *read_problem(char *filename) {
@@ -85,6 +149,10 @@ problem *read_problem(char *filename) {
   problem *p = create_problem(n, m, b, profits, constraints, capacities);
 
   free(problem_data);
+  if (!fits_in_int(p)) {
+    fprintf(stderr, "error: profits or weights of %s overflow an int\n", filename);
+    exit(1);
+  }
 
   return(p);
 }
@@ -28,17 +28,51 @@
 #include <string.h>
 #include <stdlib.h>
 #include <time.h>
+#include <stdint.h>
 
 #include "utils.h"
 
+// Maximum proportion of nonzero weights for which the item-major copy
+// of the constraints only stores the nonzeros
+#define SPARSE_DENSITY 0.25
 
+/*
+ * MKP instance
+ *
+ * n              : number of objects
+ * m              : number of knapsacks
+ * best_known     : best known value of the objective (0 if unknown)
+ * profits        : vector of length n containing the item profits
+ * constraints    : m x n matrix of item weights
+ * weights        : item-major copy of the constraints, where the m weights
+ *                  of item j are contiguous, starting at weights[j * m]
+ *                  (NULL for sparse or narrow instances)
+ * weights16      : same as weights, stored on 16 bits when every weight
+ *                  fits (NULL otherwise, or for sparse instances)
+ * sparse         : whether the item-major copy only stores the nonzero
+ *                  weights, in nz_start, nz_rows and nz_weights
+ * nz_start       : vector of length n+1, the nonzero weights of item j are
+ *                  at positions nz_start[j] to nz_start[j+1]-1 (sparse only)
+ * nz_rows        : knapsack of each nonzero weight (sparse only)
+ * nz_weights     : value of each nonzero weight (sparse only)
+ * capacities     : vector of length m containing the knapsack capacities
+ * zobrist        : vector of length n containing random 64-bit keys
+ *                  used to hash solutions (see mkpsolution.h)
+ */
 typedef struct _problem {
   int n;
   int m;
   int best_known;
   int *profits;
   int **constraints;
+  int *weights;
+  int16_t *weights16;
+  int sparse;
+  int *nz_start;
+  int *nz_rows;
+  int *nz_weights;
   int *capacities;
+  uint64_t *zobrist;
 } problem;
 
 
@@ -51,8 +85,49 @@ problem *create_problem(int n,
 
 void destroy_problem(problem *p);
 
+/*
+ * Generate the Zobrist keys of the items. Keys only depend on the
+ * item index, so that hashes are reproducible across runs.
+ */
+void create_zobrist_keys(problem *p);
+
+/*
+ * Zobrist key of an item, as generated by create_zobrist_keys.
+ *
+ * item           : index of the item
+ */
+uint64_t zobrist_key(int item);
+
+/*
+ * Build the item-major copy of the constraint matrix, so that
+ * adding, removing or checking an item reads a single contiguous column.
+ * If at most SPARSE_DENSITY of the weights are nonzero, only the nonzeros
+ * are stored, and the kernels touch only the knapsacks of the item.
+ * Otherwise, weights are stored on 16 bits if they all fit, which halves
+ * the memory traffic of the kernels.
+ */
+void create_item_major_weights(problem *p);
+
+/*
+ * Deallocate the item-major copy of the constraint matrix.
+ */
+void destroy_item_major_weights(problem *p);
+
+/*
+ * Tell whether objective values and resource usages fit in an int for
+ * any solution: the sum of the absolute profits, and for each knapsack
+ * the sum of the absolute weights plus the capacity, must not exceed
+ * INT_MAX. Solutions are not checked for overflows afterwards.
+ */
+int fits_in_int(const problem *p);
+
 void print_problem(problem *p);
 
+/*
+ * Read a single instance. The program exits if the file is truncated
+ * or malformed, or if the instance does not fit in an int (see
+ * fits_in_int).
+ */
 problem *read_problem(char *filename);
 
 #endif
@@ -19,6 +19,7 @@
  ***************************************************************************/
 
 #include "mkpsolution.h"
+#include "output.h"
 
 solution *create_empty_solution(const problem *p) {
   int n = p->n;
@@ -31,8 +32,10 @@ solution *create_empty_solution(const problem *p) {
   s->m = m;
   s->sol = (int *)calloc(n, sizeof(int));
   s->value = 0;
+  s->hash = 0;
 
   s->resources_used = (int *)calloc(m, sizeof(int));
+  s->bits = (uint64_t *)calloc(N_WORDS(n), sizeof(uint64_t));
   return(s);
 }
 
@@ -50,6 +53,8 @@ void copy_solution(const solution *src, solution *dest, const problem *p) {
     dest->sol[i] = src->sol[i];
   }
   dest->value = src->value;
+  dest->hash = src->hash;
+  memcpy(dest->bits, src->bits, N_WORDS(src->n) * sizeof(uint64_t));
   for (int i = 0 ; i < src->m ; i++) {
     dest->resources_used[i] = src->resources_used[i];
   }
@@ -57,12 +62,28 @@ void copy_solution(const solution *src, solution *dest, const problem *p) {
 
 void update_solution(solution *s, const problem const *p) {
  s->value = 0;
+ s->hash = 0;
  memset(s->resources_used, 0x00, p->m * sizeof(int));
+ memset(s->bits, 0x00, N_WORDS(s->n) * sizeof(uint64_t));
  for (int item = 0; item < s->n; item++) {
    if (s->sol[item]) {
      s->value += p->profits[item];
-     for (int i = 0 ; i < s->m ; i++) {
-       s->resources_used[i] += p->constraints[i][item];
+     s->hash ^= p->zobrist[item];
+     s->bits[item / 64] |= (1ULL << (item % 64));
+     if (p->sparse) {
+       for (int k = p->nz_start[item] ; k < p->nz_start[item + 1] ; k++) {
+         s->resources_used[p->nz_rows[k]] += p->nz_weights[k];
+       }
+     } else if (p->weights16 != NULL) {
+       const int16_t *w = p->weights16 + (size_t)item * p->m;
+       for (int i = 0 ; i < s->m ; i++) {
+         s->resources_used[i] += w[i];
+       }
+     } else {
+       const int *w = p->weights + (size_t)item * p->m;
+       for (int i = 0 ; i < s->m ; i++) {
+         s->resources_used[i] += w[i];
+       }
      }
    }
  }
@@ -83,36 +104,28 @@ solution *clone_solution(const solution *s, const problem *p) {
 }
 
 int are_identical(const solution const *s1, const solution const *s2) {
-  return(memcmp(s1->sol, s2->sol, s1->n) == 0);
+  // Different hashes imply different solutions
+  if (s1->hash != s2->hash) return(0);
+  return(memcmp(s1->sol, s2->sol, s1->n * sizeof(int)) == 0);
+}
+
+int hamming_distance(const solution *s1, const solution *s2) {
+  int distance = 0;
+  for (int w = 0 ; w < N_WORDS(s1->n) ; w++) {
+    distance += __builtin_popcountll(s1->bits[w] ^ s2->bits[w]);
+  }
+  return(distance);
 }
 
 void destroy_solution(solution *s) {
   if (s->sol != NULL) free(s->sol);
   if (s->resources_used != NULL) free(s->resources_used);
+  if (s->bits != NULL) free(s->bits);
   free(s);
 }
 
 void print_solution(const solution *s) {
-  if (get_num_selected(s) == 0) printf("No items selected in the solution!\n");
-  else {
-    printf("Items in solution:\n[ ");
-    for (int i = 0 ; i < s->n ; i++) {
-      if (s->sol[i] == 1) printf("%d ",i);
-    }
-    printf("]\n");
-  }
-
-  printf("[ ");
-  for (int i = 0 ; i < s->n ; i++) {
-    if (s->sol[i]) {
-      printf("%d ", i);
-    }
-  }
-  printf("] :: [ ");
-  for (int i = 0 ; i < s->n ; i++) {
-    if (!s->sol[i]) {
-      printf("%d ", i);
-    }
-  }
-  printf("]\n\n");
+  output_writer *w = create_output_writer(stdout);
+  write_solution_items(w, s);
+  destroy_output_writer(w);
 }
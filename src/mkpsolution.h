@@ -66,6 +66,12 @@ solution *clone_solution(const solution *s, const problem *p);
  */
 int are_identical(const solution const *s1, const solution const *s2);
 
+/*
+ * number of items on which two solutions differ (popcount of the XOR
+ * of their bitsets)
+ */
+int hamming_distance(const solution *s1, const solution *s2);
+
 /*
  * eliminate a solution
  */
@@ -0,0 +1,224 @@
+/***************************************************************************
+ *   Copyright (C) 2018 Antoine Passemiers                                 *
+ *   apassemi@ulb.ac.be                                                    *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#include "mkpsolver.h"
+#include "constructive.h"
+#include "genetic.h"
+#include "annealing.h"
+#include "eda.h"
+#include "surrogate.h"
+#include "elite.h"
+#include "relinking.h"
+#include "kernel_search.h"
+#include "checkpoint.h"
+#include "repair.h"
+#include "exchange.h"
+
+
+mkp_options create_mkp_options(void) {
+  mkp_options options;
+  memset(&options, 0x00, sizeof(mkp_options));
+  options.h = TOYODA;
+  options.max_time = -1;
+  options.bb_init = TOYODA;
+  options.bb_strategy = DEPTH_FIRST;
+  options.n_threads = 1;
+  options.elite_size = 10;
+  options.ks_bucket_size = 40;
+  options.ks_time = 1.0;
+  options.intensify = create_intensification(INTENSIFY_ALWAYS);
+  options.ga = create_ga_config();
+  options.sa = create_sa_config();
+  options.eda = create_eda_config();
+  return(options);
+}
+
+mkp_solver *create_mkp_solver(int seed) {
+  mkp_solver *solver = (mkp_solver *)malloc(sizeof(mkp_solver));
+  solver->random_state = seed_random_state(seed);
+  solver->ws = NULL;
+  solver->ws_n = 0;
+  solver->ws_m = 0;
+  solver->ws_problem = NULL;
+  return(solver);
+}
+
+void seed_mkp_solver(mkp_solver *solver, int seed) {
+  solver->random_state = seed_random_state(seed);
+}
+
+// Find a solution using the given constructive heuristic.
+// A warm start replaces the simple heuristics and seeds the others.
+static solution *construct_solution(enum constructive h,
+                                    const problem *p,
+                                    mkp_options *opt,
+                                    elite_pool *elite,
+                                    search_context *ctx) {
+  float max_time = opt->max_time;
+  if (h == SA) return(simulated_annealing(p, max_time, &opt->intensify, &opt->sa, elite, ctx));
+  else if (h == EDA) return(estimation_of_distribution(p, max_time, &opt->intensify, &opt->eda,
+                                                       opt->n_threads, elite, ctx));
+  else if (h == GA) return(genetic_algorithm(p, max_time, &opt->intensify, &opt->ga, elite, ctx));
+  else if (ctx->warm_start != NULL) return(clone_solution(ctx->warm_start, p));
+  else if (h == RANDOM) return(random_insertion(p, &ctx->random_state));
+  else if (h == GREEDY) return(greedy_insertion(p));
+  else if (h == TOYODA) return(toyoda_algorithm(p));
+  else return(surrogate_dp_insertion(p));
+}
+
+// Workspace of the local searches, reused when the dimensions match.
+// Its item orders are kept if the profits of the instance are unchanged.
+static ls_workspace *solver_workspace(mkp_solver *solver, const problem *p, int keep_orders) {
+  if ((solver->ws != NULL) && (solver->ws_n == p->n) && (solver->ws_m == p->m)) {
+    if (!keep_orders || (solver->ws_problem != p)) reset_ls_workspace(solver->ws, p);
+  } else {
+    if (solver->ws != NULL) destroy_ls_workspace(solver->ws);
+    solver->ws = create_ls_workspace(p);
+    solver->ws_n = p->n;
+    solver->ws_m = p->m;
+  }
+  solver->ws_problem = p;
+  return(solver->ws);
+}
+
+static mkp_result solve(mkp_solver *solver,
+                        const problem *p,
+                        const mkp_options *options,
+                        const mkp_callbacks *callbacks,
+                        int keep_orders) {
+  // Settings are copied: the intensification policy counts its steps
+  mkp_options opt = *options;
+  float max_time = opt.max_time;
+  mkp_timer_t exec_timer = create_timer(0);
+
+  search_context ctx;
+  init_search_context(&ctx, solver->random_state);
+  if (callbacks != NULL) {
+    ctx.on_incumbent = callbacks->on_incumbent;
+    ctx.user_data = callbacks->user_data;
+  }
+  ctx.checkpoint = opt.checkpoint;
+  ctx.resume = opt.resume;
+  // An infeasible warm start is repaired before any heuristic sees it
+  solution *repaired_start = NULL;
+  if ((opt.warm_start != NULL) && !is_feasible(opt.warm_start, p)) {
+    repaired_start = clone_solution(opt.warm_start, p);
+    repair_engine *repairer = create_repair_engine(p, REPAIR_DYNAMIC, 1, NULL);
+    repair_solution(repairer, repaired_start, NULL, p);
+    destroy_repair_engine(repairer);
+  }
+  ctx.warm_start = (repaired_start != NULL) ? repaired_start : opt.warm_start;
+  ctx.cancel = opt.cancel;
+  if (opt.share_incumbents) ctx.exchange = open_incumbent_exchange(p);
+
+  // Pool of good and diverse solutions, relinked after the search
+  elite_pool *elite = NULL;
+  if (opt.use_path_relinking) {
+    elite = create_elite_pool(opt.elite_size, (p->n < 40) ? 2 : (p->n / 20));
+  }
+
+  // Find an initial solution using a constructive heuristic
+  mkp_result result;
+  result.has_stats = 0;
+  solution *s;
+  if (resumed_snapshot(&ctx, "vnd", 2) != NULL) {
+    // VND was interrupted: the construction phase is over
+    s = create_empty_solution(p);
+  } else if (opt.h == BB) {
+    // Branch-and-bound starts from the solution of another heuristic
+    // (seeded with the warm start if any)
+    solution *initial_solution = construct_solution(opt.bb_init, p, &opt, elite, &ctx);
+    s = branch_and_bound(p, initial_solution, opt.bb_strategy,
+      opt.n_threads, max_time, &result.stats, &ctx);
+    result.has_stats = 1;
+    destroy_solution(initial_solution);
+  } else {
+    s = construct_solution(opt.h, p, &opt, elite, &ctx);
+  }
+
+  // If one of the local searches is selected, improve the initial solution
+  if (opt.use_vns) {
+    if (opt.nm == VND) {
+      variable_neighbourhood_descent(s, p, opt.h, 3, max_time, elite,
+                                     solver_workspace(solver, p, keep_orders), &ctx);
+    }
+  } else if (opt.use_ks) {
+    kernel_search(s, p, opt.ks_bucket_size, opt.ks_time, opt.n_threads, max_time, elite, &ctx);
+  } else if (opt.use_nm) {
+    improve_with_1_moves(s, p, opt.h, opt.nm, 0, max_time, elite,
+                         solver_workspace(solver, p, keep_orders), &ctx);
+  }
+
+  // Post-optimization: path relinking between elite solutions
+  if (elite != NULL) {
+    path_relinking(s, elite, p, max_time, &ctx);
+    destroy_elite_pool(elite);
+  }
+
+  report_incumbent(&ctx, s->value);
+  if (ctx.exchange != NULL) {
+    if (is_feasible(s, p)) publish_incumbent(ctx.exchange, s);
+    close_incumbent_exchange(ctx.exchange);
+  }
+  result.time = elapsed_time(&exec_timer);
+  result.s = s;
+  result.value = s->value;
+  result.feasible = is_feasible(s, p);
+  result.cancelled = is_cancelled(&ctx);
+
+  // The next solve continues the sequence of random numbers
+  solver->random_state = ctx.random_state;
+  clear_search_context(&ctx);
+  if (repaired_start != NULL) destroy_solution(repaired_start);
+  return(result);
+}
+
+mkp_result mkp_solve(mkp_solver *solver,
+                     const problem *p,
+                     const mkp_options *options,
+                     const mkp_callbacks *callbacks) {
+  return(solve(solver, p, options, callbacks, 0));
+}
+
+mkp_result mkp_reoptimize(mkp_solver *solver,
+                          instance_editor *ed,
+                          const mkp_options *options,
+                          const mkp_callbacks *callbacks) {
+  // Only a smaller capacity can make the solution infeasible
+  if (!is_feasible(ed->s, ed->p)) {
+    repair_engine *repairer = create_repair_engine(ed->p, REPAIR_DYNAMIC, 1, NULL);
+    repair_solution(repairer, ed->s, NULL, ed->p);
+    destroy_repair_engine(repairer);
+  }
+
+  // The search starts from the edited solution
+  mkp_options opt = *options;
+  opt.warm_start = ed->s;
+  int keep_orders = !(ed->changes & (EDIT_PROFITS | EDIT_ITEMS));
+  mkp_result result = solve(solver, ed->p, &opt, callbacks, keep_orders);
+  if (result.feasible && (result.value >= ed->s->value)) copy_solution(result.s, ed->s, ed->p);
+  ed->changes = 0;
+  return(result);
+}
+
+void destroy_mkp_solver(mkp_solver *solver) {
+  if (solver->ws != NULL) destroy_ls_workspace(solver->ws);
+  free(solver);
+}
@@ -0,0 +1,158 @@
+/***************************************************************************
+ *   Copyright (C) 2018 Antoine Passemiers                                 *
+ *   apassemi@ulb.ac.be                                                    *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#ifndef __MKPSOLVER_H__
+#define __MKPSOLVER_H__
+
+#include "mkpdata.h"
+#include "mkpsolution.h"
+#include "context.h"
+#include "branch_and_bound.h"
+#include "perturbative.h"
+#include "instance_edit.h"
+
+/*
+ * Library interface of the solver (libmkp.a). A solver handle owns its
+ * random generator and its scratch memory, and each call to mkp_solve
+ * keeps its state (time budget, incumbents, intensification counters)
+ * in locals of the call, so that separate handles can solve instances
+ * concurrently in one process. A handle runs one solve at a time.
+ *
+ * random_state   : state of the random generator, carried over from
+ *                  one solve to the next
+ * ws             : scratch memory of the local searches, kept between
+ *                  solves of instances of the same dimensions (NULL
+ *                  before the first solve)
+ * ws_n, ws_m     : dimensions of the instance ws was created for
+ * ws_problem     : instance ws was last used for, whose item orders
+ *                  it holds
+ */
+typedef struct _mkp_solver {
+  uint64_t random_state;
+  ls_workspace *ws;
+  int ws_n;
+  int ws_m;
+  const problem *ws_problem;
+} mkp_solver;
+
+/*
+ * Functions called during a solve (all of them can be NULL).
+ *
+ * on_incumbent   : receives each new best value, with the number of
+ *                  seconds since the start of the solve. May be called
+ *                  from the threads of the search, one call at a time.
+ * user_data      : first argument of the callbacks
+ */
+typedef struct _mkp_callbacks {
+  incumbent_callback on_incumbent;
+  void *user_data;
+} mkp_callbacks;
+
+/*
+ * Outcome of a solve.
+ *
+ * s              : best solution found, owned by the caller
+ *                  (see destroy_solution)
+ * value          : value of s
+ * feasible       : whether s is feasible
+ * time           : execution time in seconds
+ * has_stats      : whether branch-and-bound ran and filled stats
+ * stats          : statistics of branch-and-bound
+ * cancelled      : whether options->cancel was set during the solve,
+ *                  s being the best solution found until then
+ */
+typedef struct _mkp_result {
+  solution *s;
+  int value;
+  int feasible;
+  double time;
+  int has_stats;
+  bb_stats stats;
+  int cancelled;
+} mkp_result;
+
+/*
+ * Default settings: Toyoda algorithm without local search nor time limit,
+ * one thread, and the default settings of each algorithm (those of the
+ * command line).
+ */
+mkp_options create_mkp_options(void);
+
+/*
+ * Create a solver.
+ *
+ * seed           : seed of the random generator of the solver
+ */
+mkp_solver *create_mkp_solver(int seed);
+
+/*
+ * Restart the random generator of a solver, so that the next solve
+ * only depends on its instance, its options and the seed.
+ *
+ * solver         : solver handle
+ * seed           : new seed of the random generator
+ */
+void seed_mkp_solver(mkp_solver *solver, int seed);
+
+/*
+ * Solve an instance: construction with options->h (or branch-and-bound
+ * seeded with options->bb_init), then the local search selected by
+ * use_nm, use_vns or use_ks, then path relinking if requested. A snapshot
+ * in options->resume continues the search that took it. Setting the
+ * token options->cancel stops every phase at its next check of the time
+ * limit, and the best solution found so far is returned.
+ *
+ * solver         : solver handle
+ * p              : instance of MKP
+ * options        : settings of the solve, left unchanged
+ * callbacks      : functions called during the solve (can be NULL)
+ */
+mkp_result mkp_solve(mkp_solver *solver,
+                     const problem *p,
+                     const mkp_options *options,
+                     const mkp_callbacks *callbacks);
+
+/*
+ * Solve an instance again after edits (see instance_edit.h), starting
+ * from the solution kept by the editor: it is repaired if a capacity
+ * decrease made it infeasible, then used as the warm start of the
+ * search selected by the options. The item orders cached by the solver
+ * are only recomputed after edits of profits or items. The editor's
+ * solution is replaced by the result if it is at least as good, and
+ * its record of edits is cleared.
+ *
+ * solver         : solver handle
+ * ed             : editor of the instance and of its current solution
+ * options        : settings of the solve (its warm start is ignored)
+ * callbacks      : functions called during the solve (can be NULL)
+ */
+mkp_result mkp_reoptimize(mkp_solver *solver,
+                          instance_editor *ed,
+                          const mkp_options *options,
+                          const mkp_callbacks *callbacks);
+
+/*
+ * Deallocate a solver.
+ *
+ * solver         : solver to deallocate
+ */
+void destroy_mkp_solver(mkp_solver *solver);
+
+#endif // __MKPSOLVER_H__
@@ -0,0 +1,251 @@
+/***************************************************************************
+ *   Copyright (C) 2018 Antoine Passemiers                                 *
+ *   apassemi@ulb.ac.be                                                    *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#include "output.h"
+
+
+output_writer *create_output_writer(FILE *file) {
+  output_writer *w = (output_writer *)malloc(sizeof(output_writer));
+  w->file = file;
+  w->capacity = OUTPUT_BUFFER_SIZE;
+  w->buffer = (char *)malloc(w->capacity);
+  w->size = 0;
+  return(w);
+}
+
+static void drain(output_writer *w) {
+  if (w->size > 0) fwrite(w->buffer, 1, w->size, w->file);
+  w->size = 0;
+}
+
+void write_bytes(output_writer *w, const char *bytes, size_t n) {
+  if (w->size + n > w->capacity) {
+    drain(w);
+    // Large blocks bypass the buffer
+    if (n > w->capacity) {
+      fwrite(bytes, 1, n, w->file);
+      return;
+    }
+  }
+  memcpy(w->buffer + w->size, bytes, n);
+  w->size += n;
+}
+
+void write_string(output_writer *w, const char *str) {
+  write_bytes(w, str, strlen(str));
+}
+
+void write_int(output_writer *w, long long x) {
+  char digits[24];
+  int k = sizeof(digits);
+  unsigned long long u = (x < 0) ? -(unsigned long long)x : (unsigned long long)x;
+  do {
+    digits[--k] = (char)('0' + u % 10);
+    u /= 10;
+  } while (u > 0);
+  if (x < 0) digits[--k] = '-';
+  write_bytes(w, digits + k, sizeof(digits) - k);
+}
+
+void write_format(output_writer *w, const char *format, ...) {
+  char line[256];
+  va_list args;
+  va_start(args, format);
+  int n = vsnprintf(line, sizeof(line), format, args);
+  va_end(args);
+  if (n < (int)sizeof(line)) {
+    write_bytes(w, line, n);
+    return;
+  }
+  char *long_line = (char *)malloc(n + 1);
+  va_start(args, format);
+  vsnprintf(long_line, n + 1, format, args);
+  va_end(args);
+  write_bytes(w, long_line, n);
+  free(long_line);
+}
+
+void flush_output_writer(output_writer *w) {
+  drain(w);
+  fflush(w->file);
+}
+
+void destroy_output_writer(output_writer *w) {
+  flush_output_writer(w);
+  free(w->buffer);
+  free(w);
+}
+
+void write_problem(output_writer *w, const problem *p) {
+  write_string(w, "Problem data:\n");
+  write_format(w, "%d objects, %d knapsacks", p->n, p->m);
+  if (p->best_known != 0) write_format(w, ", best known value: %d", p->best_known);
+  write_string(w, "\n\n");
+
+  write_string(w, "Object profits:\n");
+  for (int j = 0 ; j < p->n ; j++) {
+    write_int(w, p->profits[j]);
+    write_bytes(w, " ", 1);
+  }
+  write_string(w, "\n\n");
+
+  write_string(w, "Constraint matrix:\n");
+  for (int i = 0 ; i < p->m ; i++) {
+    for (int j = 0 ; j < p->n ; j++) {
+      write_int(w, p->constraints[i][j]);
+      write_string(w, " * x");
+      write_int(w, j);
+      write_string(w, (j < p->n - 1) ? " + " : " <= ");
+    }
+    write_int(w, p->capacities[i]);
+    write_bytes(w, "\n", 1);
+  }
+  write_bytes(w, "\n", 1);
+}
+
+// Write the indices of the items whose selection is equal to selected
+static void write_items(output_writer *w, const solution *s, int selected) {
+  write_string(w, "[ ");
+  for (int j = 0 ; j < s->n ; j++) {
+    if (s->sol[j] == selected) {
+      write_int(w, j);
+      write_bytes(w, " ", 1);
+    }
+  }
+  write_bytes(w, "]", 1);
+}
+
+void write_solution_items(output_writer *w, const solution *s) {
+  if (get_num_selected(s) == 0) {
+    write_string(w, "No items selected in the solution!\n");
+  } else {
+    write_string(w, "Items in solution:\n");
+    write_items(w, s, 1);
+    write_bytes(w, "\n", 1);
+  }
+  write_items(w, s, 1);
+  write_string(w, " :: ");
+  write_items(w, s, 0);
+  write_string(w, "\n\n");
+}
+
+// Byte k of the bit-packed solution
+static unsigned char solution_byte(const solution *s, int k) {
+  return((unsigned char)(s->bits[k / 8] >> (8 * (k % 8))));
+}
+
+void write_bits_hex(output_writer *w, const uint64_t *bits, int n) {
+  static const char digits[] = "0123456789abcdef";
+  for (int k = 0 ; k < (n + 7) / 8 ; k++) {
+    unsigned char byte = (unsigned char)(bits[k / 8] >> (8 * (k % 8)));
+    char pair[2] = {digits[byte >> 4], digits[byte & 15]};
+    write_bytes(w, pair, 2);
+  }
+}
+
+void write_solution_hex(output_writer *w, const solution *s) {
+  write_bits_hex(w, s->bits, s->n);
+}
+
+void write_solution_base64(output_writer *w, const solution *s) {
+  static const char alphabet[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+  int n_bytes = (s->n + 7) / 8;
+  for (int k = 0 ; k < n_bytes ; k += 3) {
+    // Groups of 3 bytes give 4 characters, the last one is padded with '='
+    int n = (n_bytes - k < 3) ? (n_bytes - k) : 3;
+    uint32_t group = (uint32_t)solution_byte(s, k) << 16;
+    if (n > 1) group |= (uint32_t)solution_byte(s, k + 1) << 8;
+    if (n > 2) group |= (uint32_t)solution_byte(s, k + 2);
+    char quad[4] = {alphabet[(group >> 18) & 63], alphabet[(group >> 12) & 63],
+                    (n > 1) ? alphabet[(group >> 6) & 63] : '=',
+                    (n > 2) ? alphabet[group & 63] : '='};
+    write_bytes(w, quad, 4);
+  }
+}
+
+void write_report(output_writer *w,
+                  enum output_format format,
+                  const run_report *report,
+                  const solution *s,
+                  int terse) {
+  const bb_stats *stats = report->stats;
+  if (format == JSON_OUTPUT) {
+    write_format(w, "{\"instance\":%d,\"value\":%d,\"feasible\":%s,\"time\":%.6f,\"n\":%d",
+      report->index, report->value, report->feasible ? "true" : "false", report->time, s->n);
+    if (stats != NULL) {
+      write_format(w, ",\"nodes\":%lld,\"upper_bound\":%d,\"gap\":%.4f,\"optimal\":%s",
+        stats->n_nodes, stats->upper_bound, stats->gap, stats->optimal ? "true" : "false");
+    }
+    if (report->cancelled) write_string(w, ",\"cancelled\":true");
+    write_string(w, ",\"solution\":\"");
+    write_solution_hex(w, s);
+    write_string(w, "\"}\n");
+    return;
+  }
+
+  write_format(w, "Solution value: %d\n", report->value);
+  write_string(w, report->feasible ? "Solution is feasible.\n" : "Solution is infeasible.\n");
+  write_format(w, "Execution time in seconds: %.6f\n", report->time);
+  if (stats != NULL) {
+    write_format(w, "Branch-and-bound nodes: %lld (%.0f nodes per second)\n",
+      stats->n_nodes, stats->nodes_per_second);
+    write_format(w, "Upper bound: %d, gap: %.4f%%%s\n", stats->upper_bound,
+      stats->gap, stats->optimal ? " (optimal)" : "");
+  }
+  if (report->cancelled) write_string(w, "Search cancelled: best solution found so far.\n");
+  if (format == HEX_OUTPUT) {
+    write_string(w, "Solution: ");
+    write_solution_hex(w, s);
+    write_bytes(w, "\n", 1);
+  } else if (format == BASE64_OUTPUT) {
+    write_string(w, "Solution: ");
+    write_solution_base64(w, s);
+    write_bytes(w, "\n", 1);
+  } else if (!terse) {
+    write_solution_items(w, s);
+  }
+}
+
+progress_log *open_progress_log(const char *path) {
+  FILE *file = fopen(path, "w");
+  if (file == NULL) return(NULL);
+  progress_log *log = (progress_log *)malloc(sizeof(progress_log));
+  log->file = file;
+  log->index = 0;
+  return(log);
+}
+
+void start_progress_instance(progress_log *log, int index) {
+  log->index = index;
+}
+
+void log_incumbent(void *log, int value, double time) {
+  progress_log *l = (progress_log *)log;
+  // One line per incumbent, flushed so that the log can be followed live
+  fprintf(l->file, "{\"instance\":%d,\"time\":%.6f,\"value\":%d}\n",
+    l->index, time, value);
+  fflush(l->file);
+}
+
+void close_progress_log(progress_log *log) {
+  fclose(log->file);
+  free(log);
+}
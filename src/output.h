@@ -0,0 +1,188 @@
+/***************************************************************************
+ *   Copyright (C) 2018 Antoine Passemiers                                 *
+ *   apassemi@ulb.ac.be                                                    *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#ifndef __OUTPUT_H__
+#define __OUTPUT_H__
+
+#include <stdarg.h>
+
+#include "mkpalgotypes.h"
+#include "mkpsolution.h"
+#include "branch_and_bound.h"
+
+// Size of the buffer of a writer
+#define OUTPUT_BUFFER_SIZE 65536
+
+/*
+ * Buffered writer: output is accumulated in memory and written to the
+ * file in large blocks, instead of one call to printf per number.
+ *
+ * file           : destination
+ * buffer         : pending bytes
+ * size           : number of pending bytes
+ * capacity       : size of buffer
+ */
+typedef struct _output_writer {
+  FILE *file;
+  char *buffer;
+  size_t size;
+  size_t capacity;
+} output_writer;
+
+/*
+ * Outcome of the resolution of one instance, as reported by write_report.
+ *
+ * index          : index of the instance in its file (starting at 1)
+ * value          : value of the solution
+ * feasible       : whether the solution is feasible
+ * time           : execution time in seconds
+ * stats          : statistics of branch-and-bound (NULL for other solvers)
+ * cancelled      : whether the search was cancelled before its end
+ */
+typedef struct _run_report {
+  int index;
+  int value;
+  int feasible;
+  double time;
+  const bb_stats *stats;
+  int cancelled;
+} run_report;
+
+/*
+ * Create a writer with a buffer of OUTPUT_BUFFER_SIZE bytes.
+ *
+ * file           : destination (not closed by the writer)
+ */
+output_writer *create_output_writer(FILE *file);
+
+/*
+ * Append bytes, a string, an integer or formatted text (as printf)
+ * to the buffer, which is written to the file when full.
+ */
+void write_bytes(output_writer *w, const char *bytes, size_t n);
+void write_string(output_writer *w, const char *str);
+void write_int(output_writer *w, long long x);
+void write_format(output_writer *w, const char *format, ...);
+
+/*
+ * Write the pending bytes to the file and flush it.
+ */
+void flush_output_writer(output_writer *w);
+
+/*
+ * Flush and deallocate a writer.
+ */
+void destroy_output_writer(output_writer *w);
+
+/*
+ * Human-readable description of an instance: profits and constraints.
+ */
+void write_problem(output_writer *w, const problem *p);
+
+/*
+ * Human-readable lists of the selected and discarded items.
+ */
+void write_solution_items(output_writer *w, const solution *s);
+
+/*
+ * Bit-packed encodings of a solution: ceil(n/8) bytes where byte k holds
+ * items 8k to 8k+7, item 8k in its least significant bit, written in
+ * hexadecimal (two digits per byte, most significant digit first)
+ * or in base64 (RFC 4648, with padding).
+ */
+void write_solution_hex(output_writer *w, const solution *s);
+void write_solution_base64(output_writer *w, const solution *s);
+
+/*
+ * Hexadecimal encoding of the bit vector of a solution of n items
+ * (as write_solution_hex), for callers that keep only the bits.
+ */
+void write_bits_hex(output_writer *w, const uint64_t *bits, int n);
+
+/*
+ * Report the solution of an instance in the given format:
+ *   TEXT_OUTPUT   : value, feasibility, time and statistics on separate
+ *                   lines, followed by the item lists unless terse
+ *   JSON_OUTPUT   : one compact JSON object per line, the solution being
+ *                   given in hexadecimal
+ *   HEX_OUTPUT,
+ *   BASE64_OUTPUT : same lines as TEXT_OUTPUT, the item lists being
+ *                   replaced by the encoded solution
+ *
+ * w              : writer
+ * format         : output format
+ * report         : outcome of the resolution
+ * s              : solution
+ * terse          : whether to omit the item lists (TEXT_OUTPUT only)
+ */
+void write_report(output_writer *w,
+                  enum output_format format,
+                  const run_report *report,
+                  const solution *s,
+                  int terse);
+
+/*
+ * Progress log: a JSON-lines file receiving one line per new incumbent,
+ * {"instance": k, "time": t, "value": v}, where t is the number of
+ * seconds since the instance started. Incumbents are passed to the log
+ * by the context of the solve (see context.h), which keeps only the
+ * improvements and serializes the threads of the search.
+ *
+ * file           : log file
+ * index          : index of the current instance
+ */
+typedef struct _progress_log {
+  FILE *file;
+  int index;
+} progress_log;
+
+/*
+ * Open a progress log. Returns NULL if the file cannot be created.
+ *
+ * path           : path to the log file
+ */
+progress_log *open_progress_log(const char *path);
+
+/*
+ * Start logging the incumbents of a new instance.
+ *
+ * log            : progress log
+ * index          : index of the instance in its file (starting at 1)
+ */
+void start_progress_instance(progress_log *log, int index);
+
+/*
+ * Log a new incumbent value. Has the signature of an incumbent_callback,
+ * the log being its user data.
+ *
+ * log            : progress log
+ * value          : value of the new best solution
+ * time           : number of seconds since the instance started
+ */
+void log_incumbent(void *log, int value, double time);
+
+/*
+ * Flush and close a progress log.
+ *
+ * log            : progress log to deallocate
+ */
+void close_progress_log(progress_log *log);
+
+#endif // __OUTPUT_H__
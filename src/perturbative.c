@@ -21,39 +21,95 @@
 #include "perturbative.h"
 
 
+ls_workspace *create_ls_workspace(const problem *p) {
+  ls_workspace *ws = (ls_workspace *)malloc(sizeof(ls_workspace));
+  ws->current = create_empty_solution(p);
+  ws->best = create_empty_solution(p);
+  // Orders are drawn or computed before each use
+  ws->random_indexes = (int *)malloc(p->n * sizeof(int));
+  ws->indexes = (int *)malloc(p->n * sizeof(int));
+  ws->u = (float *)malloc(p->m * sizeof(float));
+  ws->v = (float *)malloc(p->n * sizeof(float));
+  ws->pseudo_utilities = (float *)malloc(p->n * sizeof(float));
+  ws->greedy_order = (int *)malloc(p->n * sizeof(int));
+  reset_ls_workspace(ws, p);
+  return(ws);
+}
+
+void reset_ls_workspace(ls_workspace *ws, const problem *p) {
+  // Items sorted by profit never change during a search: sort them once
+  float *rv_profits = (float *)malloc(p->n * sizeof(float));
+  for (int j = 0 ; j < p->n ; j++) rv_profits[j] = (float)p->profits[j];
+  indexes_of_sorted_array(ws->greedy_order, rv_profits, p->n);
+  free(rv_profits);
+}
+
+void destroy_ls_workspace(ls_workspace *ws) {
+  destroy_solution(ws->current);
+  destroy_solution(ws->best);
+  free(ws->random_indexes);
+  free(ws->indexes);
+  free(ws->greedy_order);
+  free(ws->u);
+  free(ws->v);
+  free(ws->pseudo_utilities);
+  free(ws);
+}
+
+// Order in which items are inserted back after a removal
+static const int *insertion_order(ls_workspace *ws,
+                                  const solution *current_solution,
+                                  enum constructive h,
+                                  const problem *p,
+                                  uint64_t *random_state) {
+  if (h == RANDOM) {
+    // In the case of random selection, the order is shuffled
+    fill_shuffled(ws->indexes, p->n, random_state);
+  } else if (h == GREEDY) {
+    // In the case of greedy heuristic, items are sorted by profit
+    return(ws->greedy_order);
+  } else {
+    // In the case of Toyoda heuristic, items are sorted by pseudo-utilities
+    compute_pseudo_utilities(ws->u, ws->v, ws->pseudo_utilities, current_solution, p);
+    indexes_of_sorted_array(ws->indexes, ws->pseudo_utilities, p->n);
+  }
+  return(ws->indexes);
+}
+
 void improve_with_1_moves(solution *initial_solution,
                           const problem *p,
                           enum constructive h,
                           enum perturbative nm,
-                          float max_time) {
-  // Temporary solutions
-  solution *current_solution = create_empty_solution(p);
-  solution *best_solution = create_empty_solution(p);
+                          int max_moves,
+                          float max_time,
+                          elite_pool *elite,
+                          ls_workspace *ws,
+                          search_context *ctx) {
+  // Scratch memory is allocated only if the caller provides none
+  ls_workspace *own_ws = (ws == NULL) ? create_ls_workspace(p) : NULL;
+  if (ws == NULL) ws = own_ws;
+
+  // Temporary solutions. The best solution starts as the initial one,
+  // which is kept as is if no improving move exists.
+  solution *current_solution = ws->current;
+  solution *best_solution = ws->best;
+  copy_solution(initial_solution, best_solution, p);
+  int *random_indexes = ws->random_indexes;
 
   // Keeping control flow consistent
   int best_value = initial_solution->value;
   int improving = 1;
 
-  // Temporary arrays for shuffling sequences by index
-  int *random_indexes = create_shuffled(p->n);
-  int *indexes = create_shuffled(p->n); // Used only by the random selection heuristic
-
-  // Allocate temporary arrays for doing the computing in the framework
-  // of the Toyoda algorithm and the greedy heuristic.
-  // This is done even when none of those heuristics are used since the memory
-  // footprint is negligible.
-  float *rv_profits = (float *)malloc(p->n * sizeof(float));
-  float *u = (float *)malloc(p->m * sizeof(float));
-  float *v = (float *)malloc(p->n * sizeof(float));
-  float *pseudo_utilities = (float *)malloc(p->n * sizeof(float));
-
-  timer_t timer = create_timer(max_time);
-  while (improving && !finished(&timer)) {
+  int n_moves = 0;
+  mkp_timer_t timer = create_search_timer(ctx, max_time);
+  while (improving && !finished(&timer) && ((max_moves <= 0) || (n_moves < max_moves))) {
     improving = 0; // We still have to find a better solution
     // The order in which items are evaluated for removal is random.
     // In the case of Best-Improvement, shuffling the order does
-    // not make a difference.
-    shuffle_int(random_indexes, p->n);
+    // not make a difference (except between ties).
+    // The order is drawn afresh, so that it only depends on the random
+    // state, which is what checkpoints save.
+    fill_shuffled(random_indexes, p->n, &ctx->random_state);
     for (int i = 0; (i < p->n) && !finished(&timer); i++) {
       int old_item = random_indexes[i];
       // Incumbent solution
@@ -61,19 +117,8 @@ void improve_with_1_moves(solution *initial_solution,
       if (current_solution->sol[old_item]) {
         // Remove the selected item (only the present one since k = 1)
         remove_item(current_solution, old_item, p);
+        const int *indexes = insertion_order(ws, current_solution, h, p, &ctx->random_state);
 
-        if (h == RANDOM) {
-          // In the case of random selection, the order is shuffled
-          shuffle_int(indexes, p->n);
-        } else if (h == GREEDY) {
-          // In the case of greedy heuristic, items are sorted by profit
-          for (int j = 0 ; j < p->n ; j++) rv_profits[j] = (float)p->profits[j];
-          indexes_of_sorted_array(indexes, rv_profits, p->n);
-        } else {
-          // In the case of Toyoda heuristic, items are sorted by pseudo-utilities
-          compute_pseudo_utilities(u, v, pseudo_utilities, current_solution, p);
-          indexes_of_sorted_array(indexes, pseudo_utilities, p->n);
-        }
         // Add new items (except the one that has just been removed) in the appropriate
         // order (given by the perturbative heuristic) while keeping the solution feasible.
         for (int r = 0 ; r < p->n ; r++) {
@@ -90,22 +135,18 @@ void improve_with_1_moves(solution *initial_solution,
         best_value = current_solution->value;
         improving = 1;
         copy_solution(current_solution, best_solution, p);
+        offer_elite(elite, best_solution, p);
+        report_incumbent(ctx, best_value);
         if (nm == FI) break;
       }
     }
     // In case of Best-Improvement heuristic, the best solution is copied
     // into the initial solution.
     copy_solution(best_solution, initial_solution, p);
+    n_moves += improving;
   }
 
-  // Deallocate all temporary data
-  destroy_solution(current_solution);
-  free(indexes);
-  free(random_indexes);
-  free(rv_profits);
-  free(u);
-  free(v);
-  free(pseudo_utilities);
+  if (own_ws != NULL) destroy_ls_workspace(own_ws);
 }
 
 
@@ -113,37 +154,65 @@ void variable_neighbourhood_descent(solution *initial_solution,
                                     const problem *p,
                                     enum constructive h,
                                     int k_max,
-                                    float max_time) {
-
-  // We allocate a temporary solution called "best_solution" to store
+                                    float max_time,
+                                    elite_pool *elite,
+                                    ls_workspace *ws,
+                                    search_context *ctx) {
+  // Scratch memory is allocated only if the caller provides none
+  ls_workspace *own_ws = (ws == NULL) ? create_ls_workspace(p) : NULL;
+  if (ws == NULL) ws = own_ws;
+
+  // A temporary solution called "best_solution" stores
   // the temporary best solution. Indeed, the VND algorithm has been
   // implemented in a Best-Improvement fashion.
-  solution *current_solution = create_empty_solution(p);
-  solution *best_solution = create_empty_solution(p);
+  solution *current_solution = ws->current;
+  solution *best_solution = ws->best;
+  copy_solution(initial_solution, best_solution, p);
 
   // Keeping control flow consistent
   int best_value = initial_solution->value;
   int improving = 1;
+  int k_start = 1;
+
+  // A resumed pass continues from the saved neighbourhood, with the
+  // solution it started from and the best one found so far
+  mkp_timer_t timer = create_search_timer(ctx, max_time);
+  const snapshot *resume = resumed_snapshot(ctx, "vnd", 2);
+  if (resume != NULL) {
+    load_solution(resume, 0, initial_solution, p);
+    load_solution(resume, 1, best_solution, p);
+    best_value = best_solution->value;
+    k_start = (int)load_value(resume, "k", 1);
+    resume_search(resume, ctx, &timer);
+  }
 
-  // Temporary array for shuffling sequences by index
-  int *indexes = create_shuffled(p->n);
-
-  // Allocate temporary arrays for doing the computing in the framework
-  // of the Toyoda algorithm and the greedy heuristic.
-  // This is done even when none of those heuristics are used since the memory
-  // footprint is negligible.
-  float *rv_profits = (float *)malloc(p->n * sizeof(float));
-  float *u = (float *)malloc(p->m * sizeof(float));
-  float *v = (float *)malloc(p->n * sizeof(float));
-  float *pseudo_utilities = (float *)malloc(p->n * sizeof(float));
-
-  timer_t timer = create_timer(max_time);
-  while (improving && !finished(&timer)) {
-    improving = 0; // We still have to find a better solution
+  while ((improving || (k_start > 1)) && !finished(&timer)) {
+    improving = (k_start > 1) && (best_value > initial_solution->value);
     // The size of the neighbourhood is increasing over time.
     // Since we are considering the Best-Improvement, the order does
     // not make a difference.
-    for (int k = 1; (k <= k_max) && !finished(&timer); k++) {
+    for (int k = k_start; (k <= k_max) && !finished(&timer); k++) {
+      // Incumbents are exchanged with the other processes between two
+      // neighbourhoods: the descent restarts from a better one found elsewhere
+      publish_incumbent(ctx->exchange, best_solution);
+      const solution *shared = import_incumbent(ctx->exchange, best_value, p);
+      if (shared != NULL) {
+        copy_solution(shared, best_solution, p);
+        best_value = best_solution->value;
+        improving = 1;
+        report_incumbent(ctx, best_value);
+        break;
+      }
+
+      // Snapshot of the search, taken between two neighbourhoods
+      snapshot *snap = begin_snapshot(ctx, "vnd", &timer, p);
+      if (snap != NULL) {
+        save_solution(snap, initial_solution);
+        save_solution(snap, best_solution);
+        save_value(snap, "k", k);
+        commit_snapshot(ctx);
+      }
+
       // Initialize the lexicographically first combinations of k 1's
       // in an array of num_selected binary values.
       k_move *move = create_empty_k_move(k, initial_solution);
@@ -155,18 +224,7 @@ void variable_neighbourhood_descent(solution *initial_solution,
           int old_item = move->indexes[i];
           if (move->removed[old_item]) remove_item(current_solution, old_item, p);
         }
-        if (h == RANDOM) {
-          // In the case of random selection, the order is shuffled
-          shuffle_int(indexes, p->n);
-        } else if (h == GREEDY) {
-          // In the case of greedy heuristic, items are sorted by profit
-          for (int j = 0 ; j < p->n ; j++) rv_profits[j] = (float)p->profits[j];
-          indexes_of_sorted_array(indexes, rv_profits, p->n);
-        } else {
-          // In the case of Toyoda heuristic, items are sorted by pseudo-utilities
-          compute_pseudo_utilities(u, v, pseudo_utilities, current_solution, p);
-          indexes_of_sorted_array(indexes, pseudo_utilities, p->n);
-        }
+        const int *indexes = insertion_order(ws, current_solution, h, p, &ctx->random_state);
         // Add new items (except the ones that have just been removed) in the appropriate
         // order (given by the perturbative heuristic) while keeping the solution feasible.
         for (int r = 0 ; r < p->n ; r++) {
@@ -178,21 +236,17 @@ void variable_neighbourhood_descent(solution *initial_solution,
           best_value = current_solution->value;
           improving = 1;
           copy_solution(current_solution, best_solution, p);
+          offer_elite(elite, best_solution, p);
+          report_incumbent(ctx, best_value);
         }
       // Stop iterating once we get the lexicographically last combination of 1's
       // contained in "move".
       } while (iterate_k_move(move) && !finished(&timer));
       destroy_k_move(move);
     }
+    k_start = 1;
     copy_solution(best_solution, initial_solution, p);
   }
 
-  // Deallocate all temporary data
-  destroy_solution(best_solution);
-  destroy_solution(current_solution);
-  free(indexes);
-  free(rv_profits);
-  free(u);
-  free(v);
-  free(pseudo_utilities);
+  if (own_ws != NULL) destroy_ls_workspace(own_ws);
 }
\ No newline at end of file
@@ -25,6 +25,46 @@
 #include "mkpalgotypes.h"
 #include "constructive.h"
 #include "k_move.h"
+#include "elite.h"
+#include "checkpoint.h"
+#include "exchange.h"
+
+/*
+ * Scratch memory of the local search routines, reused across calls
+ * so that repeated local searches (e.g. intensification in SA and GA)
+ * do not allocate anything.
+ *
+ * current        : candidate solution
+ * best           : best solution of the current pass
+ * random_indexes : order in which items are considered for removal
+ * indexes        : order in which items are inserted back
+ * greedy_order   : items sorted by decreasing profit
+ * u, v, pseudo_utilities : buffers of compute_pseudo_utilities
+ */
+typedef struct _ls_workspace {
+  solution *current;
+  solution *best;
+  int *random_indexes;
+  int *indexes;
+  int *greedy_order;
+  float *u;
+  float *v;
+  float *pseudo_utilities;
+} ls_workspace;
+
+ls_workspace *create_ls_workspace(const problem *p);
+
+/*
+ * Prepare a workspace for a new instance of the same dimensions,
+ * whose items may have other profits.
+ *
+ * ws             : workspace created for an instance with as many
+ *                  items and knapsacks as p
+ * p              : instance the workspace is used for
+ */
+void reset_ls_workspace(ls_workspace *ws, const problem *p);
+
+void destroy_ls_workspace(ls_workspace *ws);
 
 /*
  * If nm is FI, apply first-improvement algorithm with respect to
@@ -37,13 +77,23 @@
  *                  the initial solution
  * initial_sol    : Initial solution found with heuristic h
  * nm             : Perturbative algorithm to apply
+ * max_moves      : Maximum number of improving moves (0 for no limit).
+ *                  With best-improvement, a move is a full pass over
+ *                  the neighbourhood.
  * max_time       : Limit for the execution time
+ * elite          : Pool where improving solutions are offered (can be NULL)
+ * ws             : Scratch memory (NULL to allocate a temporary one)
+ * ctx            : Context of the solve (random state, incumbents)
  */
 void improve_with_1_moves(solution *initial_sol, 
                           const problem *p, 
                           enum constructive h, 
                           enum perturbative nm,
-                          float max_time);
+                          int max_moves,
+                          float max_time,
+                          elite_pool *elite,
+                          ls_workspace *ws,
+                          search_context *ctx);
 
 /*
  * Apply Variable Neighbourhood Descent algorithm with respect to
@@ -60,11 +110,20 @@ void improve_with_1_moves(solution *initial_sol,
  *                  If k_max == 3, then all k-moves will be
  *                  evaluated, where k is in {1, 2, 3}.
  * max_time       : Limit for the execution time
+ * elite          : Pool where improving solutions are offered (can be NULL)
+ * ws             : Scratch memory (NULL to allocate a temporary one)
+ * ctx            : Context of the solve (random state, incumbents),
+ *                  with the checkpoints of the incumbent taken before
+ *                  each neighbourhood and the snapshot to resume from,
+ *                  which replaces initial_sol
  */
 void variable_neighbourhood_descent(solution *initial_sol, 
                                     const problem *p, 
                                     enum constructive h, 
                                     int k_max,
-                                    float max_time);
+                                    float max_time,
+                                    elite_pool *elite,
+                                    ls_workspace *ws,
+                                    search_context *ctx);
 
 #endif // __PERTURBATIVE_H__
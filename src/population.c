@@ -0,0 +1,189 @@
+/***************************************************************************
+ *   Copyright (C) 2018 Antoine Passemiers                                 *
+ *   apassemi@ulb.ac.be                                                    *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#include "population.h"
+
+
+population *create_population(int capacity) {
+  population *pop = (population *)malloc(sizeof(population));
+  pop->size = 0;
+  pop->capacity = capacity;
+  pop->members = (solution **)malloc(capacity * sizeof(solution *));
+  pop->heap = (int *)malloc(capacity * sizeof(int));
+  pop->heap_pos = (int *)malloc(capacity * sizeof(int));
+
+  // Keep the load factor of the hash table below 1/2
+  int n_slots = 1;
+  while (n_slots < 2 * capacity) n_slots <<= 1;
+  pop->table_mask = n_slots - 1;
+  pop->table = (int *)malloc(n_slots * sizeof(int));
+  memset(pop->table, 0xFF, n_slots * sizeof(int));
+  pop->best = -1;
+  return(pop);
+}
+
+static void heap_swap(population *pop, int a, int b) {
+  int tmp = pop->heap[a];
+  pop->heap[a] = pop->heap[b];
+  pop->heap[b] = tmp;
+  pop->heap_pos[pop->heap[a]] = a;
+  pop->heap_pos[pop->heap[b]] = b;
+}
+
+static int heap_value(const population *pop, int pos) {
+  return(pop->members[pop->heap[pos]]->value);
+}
+
+static void heap_sift_up(population *pop, int pos) {
+  while ((pos > 0) && (heap_value(pop, (pos - 1) / 2) > heap_value(pop, pos))) {
+    heap_swap(pop, pos, (pos - 1) / 2);
+    pos = (pos - 1) / 2;
+  }
+}
+
+static void heap_sift_down(population *pop, int pos) {
+  while (1) {
+    int l = 2 * pos + 1, r = l + 1, smallest = pos;
+    if ((l < pop->size) && (heap_value(pop, l) < heap_value(pop, smallest))) smallest = l;
+    if ((r < pop->size) && (heap_value(pop, r) < heap_value(pop, smallest))) smallest = r;
+    if (smallest == pos) break;
+    heap_swap(pop, pos, smallest);
+    pos = smallest;
+  }
+}
+
+static void table_insert(population *pop, int index) {
+  int slot = (int)(pop->members[index]->hash & pop->table_mask);
+  while (pop->table[slot] >= 0) slot = (slot + 1) & pop->table_mask;
+  pop->table[slot] = index;
+}
+
+static void table_remove(population *pop, int index) {
+  int slot = (int)(pop->members[index]->hash & pop->table_mask);
+  while (pop->table[slot] != index) slot = (slot + 1) & pop->table_mask;
+  // Backward-shift deletion: move back the entries of the cluster
+  // that would not be reachable anymore from their home slot.
+  int hole = slot;
+  pop->table[hole] = -1;
+  slot = (slot + 1) & pop->table_mask;
+  while (pop->table[slot] >= 0) {
+    int home = (int)(pop->members[pop->table[slot]]->hash & pop->table_mask);
+    if (((slot - home) & pop->table_mask) >= ((slot - hole) & pop->table_mask)) {
+      pop->table[hole] = pop->table[slot];
+      pop->table[slot] = -1;
+      hole = slot;
+    }
+    slot = (slot + 1) & pop->table_mask;
+  }
+}
+
+void add_member(population *pop, solution *s) {
+  int index = pop->size++;
+  pop->members[index] = s;
+  pop->heap[index] = index;
+  pop->heap_pos[index] = index;
+  heap_sift_up(pop, index);
+  table_insert(pop, index);
+  if ((pop->best < 0) || (s->value > pop->members[pop->best]->value)) pop->best = index;
+}
+
+int has_member(const population *pop, const solution *s) {
+  int slot = (int)(s->hash & pop->table_mask);
+  while (pop->table[slot] >= 0) {
+    // Solutions are only compared when their hashes are equal
+    if (are_identical(s, pop->members[pop->table[slot]])) return(1);
+    slot = (slot + 1) & pop->table_mask;
+  }
+  return(0);
+}
+
+int get_worst_member(const population *pop) {
+  return(pop->heap[0]);
+}
+
+int get_best_member(const population *pop) {
+  return(pop->best);
+}
+
+void sample_members(const population *pop, int k, int *indices, uint64_t *random_state) {
+  // For j = size-k, ..., size-1, draw t in [0, j] and keep it
+  // unless already drawn, in which case j is kept instead
+  int n_drawn = 0;
+  for (int j = pop->size - k ; j < pop->size ; j++) {
+    int t = random_int(random_state, j + 1);
+    for (int d = 0 ; d < n_drawn ; d++) {
+      if (indices[d] == t) {
+        t = j;
+        break;
+      }
+    }
+    indices[n_drawn++] = t;
+  }
+  // Floyd's algorithm draws a uniform set, but collisions put the last
+  // indices at the end: the order is made uniform too (Fisher-Yates, O(k))
+  for (int i = k - 1 ; i >= 1 ; i--) {
+    int j = random_int(random_state, i + 1);
+    int tmp = indices[i];
+    indices[i] = indices[j];
+    indices[j] = tmp;
+  }
+}
+
+int set_heap_order(population *pop, const int *heap) {
+  // heap_pos is used to detect duplicates, and rebuilt if heap is invalid
+  for (int i = 0 ; i < pop->size ; i++) pop->heap_pos[i] = -1;
+  int valid = 1;
+  for (int pos = 0 ; (pos < pop->size) && valid ; pos++) {
+    int index = heap[pos];
+    valid = (index >= 0) && (index < pop->size) && (pop->heap_pos[index] < 0) && \
+      ((pos == 0) || (pop->members[heap[(pos - 1) / 2]]->value <= pop->members[index]->value));
+    if (valid) pop->heap_pos[index] = pos;
+  }
+  if (valid) memcpy(pop->heap, heap, pop->size * sizeof(int));
+  for (int pos = 0 ; pos < pop->size ; pos++) pop->heap_pos[pop->heap[pos]] = pos;
+  return(valid);
+}
+
+solution *replace_member(population *pop, int index, solution *s) {
+  table_remove(pop, index);
+  solution *old = pop->members[index];
+  pop->members[index] = s;
+  table_insert(pop, index);
+  if (s->value < old->value) heap_sift_up(pop, pop->heap_pos[index]);
+  else heap_sift_down(pop, pop->heap_pos[index]);
+
+  if (s->value > pop->members[pop->best]->value) {
+    pop->best = index;
+  } else if ((index == pop->best) && (s->value < old->value)) {
+    for (int i = 0 ; i < pop->size ; i++) {
+      if (pop->members[i]->value > pop->members[pop->best]->value) pop->best = i;
+    }
+  }
+  return(old);
+}
+
+void destroy_population(population *pop) {
+  for (int i = 0 ; i < pop->size ; i++) destroy_solution(pop->members[i]);
+  free(pop->members);
+  free(pop->heap);
+  free(pop->heap_pos);
+  free(pop->table);
+  free(pop);
+}
@@ -0,0 +1,135 @@
+/***************************************************************************
+ *   Copyright (C) 2018 Antoine Passemiers                                 *
+ *   apassemi@ulb.ac.be                                                    *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#ifndef __POPULATION_H__
+#define __POPULATION_H__
+
+#include "mkpsolution.h"
+
+/*
+ * Population of solutions used by the genetic algorithm.
+ * Members are indexed by a hash set on their Zobrist hashes, for
+ * constant-time duplicate detection, and by a binary min-heap on their
+ * objective values, for logarithmic-time replacement of the worst member.
+ * The best member is tracked as members are added and replaced.
+ *
+ * size           : number of members
+ * capacity       : maximum number of members
+ * members        : array of pointers to the members
+ * heap           : min-heap of member indices, ordered by objective value
+ * heap_pos       : heap_pos[i] is the position of member i in heap
+ * table          : open-addressing hash table of member indices
+ *                  (-1 for empty slots), probed linearly
+ * table_mask     : number of slots in table minus one (power of 2)
+ * best           : index of a member with highest objective value
+ */
+typedef struct _population {
+  int size;
+  int capacity;
+  solution **members;
+  int *heap;
+  int *heap_pos;
+  int *table;
+  int table_mask;
+  int best;
+} population;
+
+/*
+ * Create an empty population.
+ *
+ * capacity       : maximum number of members
+ */
+population *create_population(int capacity);
+
+/*
+ * Add a new member to a non-full population. The population takes
+ * ownership of the solution. Duplicates are allowed.
+ *
+ * pop            : population
+ * s              : new member
+ */
+void add_member(population *pop, solution *s);
+
+/*
+ * Tell whether a solution identical to s is a member of the population.
+ *
+ * pop            : population
+ * s              : solution to look for
+ */
+int has_member(const population *pop, const solution *s);
+
+/*
+ * Return the index of the member with lowest fitness.
+ *
+ * pop            : population
+ */
+int get_worst_member(const population *pop);
+
+/*
+ * Return the index of the member with highest fitness.
+ *
+ * pop            : population
+ */
+int get_best_member(const population *pop);
+
+/*
+ * Draw k distinct members uniformly at random (Floyd's algorithm),
+ * in O(k^2) time regardless of the population size. The indices are
+ * shuffled, so that any part of them is also a uniform sample.
+ *
+ * pop            : population
+ * k              : number of members to draw (at most pop->size)
+ * indices        : output vector of length k containing their indices
+ * random_state   : state of the random generator
+ */
+void sample_members(const population *pop, int k, int *indices, uint64_t *random_state);
+
+/*
+ * Restore the order of the heap of a population, as saved from
+ * pop->heap, so that ties between members are broken as they were.
+ * Returns 0, leaving the heap unchanged, if heap is not a permutation
+ * of the member indices ordered as a heap.
+ *
+ * pop            : population
+ * heap           : vector of length pop->size
+ */
+int set_heap_order(population *pop, const int *heap);
+
+/*
+ * Replace a member by a new solution. The population takes ownership
+ * of the new one, and the old member is returned to the caller, who
+ * must destroy or recycle it. Replacing the best member by a worse
+ * solution costs a linear scan to find the new best one; replacing
+ * any other member costs O(log size).
+ *
+ * pop            : population
+ * index          : index of the member to replace
+ * s              : new member
+ */
+solution *replace_member(population *pop, int index, solution *s);
+
+/*
+ * Deallocate a population and all its members.
+ *
+ * pop            : population to deallocate
+ */
+void destroy_population(population *pop);
+
+#endif // __POPULATION_H__
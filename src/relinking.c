@@ -0,0 +1,132 @@
+/***************************************************************************
+ *   Copyright (C) 2018 Antoine Passemiers                                 *
+ *   apassemi@ulb.ac.be                                                    *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#include "relinking.h"
+
+
+int relink(const solution *initiating,
+           const solution *guiding,
+           solution *best,
+           solution *current,
+           solution *completed,
+           const int *rank,
+           const surrogate *sr,
+           const problem *p) {
+  int n = p->n;
+  best->value = -1;
+  copy_solution(initiating, current, p);
+
+  // Items on which both solutions differ, found word by word.
+  // Both lists are indexed by surrogate rank: to_add is scanned by
+  // decreasing efficiency, to_drop by increasing efficiency.
+  char *to_add = (char *)calloc(n, 1);
+  char *to_drop = (char *)calloc(n, 1);
+  int n_add = 0;
+  for (int w = 0 ; w < N_WORDS(n) ; w++) {
+    uint64_t diff = initiating->bits[w] ^ guiding->bits[w];
+    while (diff) {
+      int item = 64 * w + __builtin_ctzll(diff);
+      diff &= diff - 1;
+      if (guiding->sol[item]) {
+        to_add[rank[item]] = 1;
+        n_add++;
+      } else {
+        to_drop[rank[item]] = 1;
+      }
+    }
+  }
+
+  int drop_pos = n - 1;
+  while (n_add > 0) {
+    // Most efficient item of the guiding solution that fits,
+    // or the most efficient one if none fits
+    int chosen = -1;
+    for (int r = 0 ; r < n ; r++) {
+      if (!to_add[r]) continue;
+      if (chosen < 0) chosen = r;
+      if (!check_item(current, sr->order[r], p)) {
+        chosen = r;
+        break;
+      }
+    }
+    to_add[chosen] = 0;
+    n_add--;
+    add_item(current, sr->order[chosen], p);
+
+    // Repair by dropping the least efficient items the guide discards.
+    // The path ends if none is left (the guide is infeasible).
+    while (!is_feasible(current, p) && (drop_pos >= 0)) {
+      while ((drop_pos >= 0) && !to_drop[drop_pos]) drop_pos--;
+      if (drop_pos < 0) break;
+      to_drop[drop_pos] = 0;
+      remove_item(current, sr->order[drop_pos], p);
+    }
+    if (!is_feasible(current, p)) break;
+
+    // Evaluate the intermediate solution after a greedy completion
+    copy_solution(current, completed, p);
+    for (int r = 0 ; r < n ; r++) check_and_add_item(completed, sr->order[r], p);
+    if (completed->value > best->value) copy_solution(completed, best, p);
+  }
+
+  free(to_add);
+  free(to_drop);
+  return(best->value);
+}
+
+void path_relinking(solution *s, elite_pool *pool, const problem *p, float max_time,
+                    search_context *ctx) {
+  offer_elite(pool, s, p);
+  if (pool->size < 2) return;
+
+  mkp_timer_t timer = create_search_timer(ctx, max_time);
+  surrogate *sr = create_surrogate(p, 20);
+  int *rank = (int *)malloc(p->n * sizeof(int));
+  for (int r = 0 ; r < p->n ; r++) rank[sr->order[r]] = r;
+
+  solution *candidate = create_empty_solution(p);
+  solution *current = create_empty_solution(p);
+  solution *completed = create_empty_solution(p);
+
+  int improving = 1;
+  while (improving && !finished(&timer)) {
+    improving = 0;
+    for (int i = 0 ; (i < pool->size) && !finished(&timer) ; i++) {
+      for (int j = 0 ; (j < pool->size) && !finished(&timer) ; j++) {
+        if (i == j) continue;
+        // Nothing to relink if the guide is included in the initiating solution
+        if (relink(pool->members[i], pool->members[j],
+                   candidate, current, completed, rank, sr, p) < 0) continue;
+        if (candidate->value > s->value) {
+          copy_solution(candidate, s, p);
+          report_incumbent(ctx, s->value);
+          improving = 1;
+        }
+        offer_elite(pool, candidate, p);
+      }
+    }
+  }
+
+  destroy_solution(candidate);
+  destroy_solution(current);
+  destroy_solution(completed);
+  free(rank);
+  destroy_surrogate(sr);
+}
@@ -0,0 +1,76 @@
+/***************************************************************************
+ *   Copyright (C) 2018 Antoine Passemiers                                 *
+ *   apassemi@ulb.ac.be                                                    *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#ifndef __RELINKING_H__
+#define __RELINKING_H__
+
+#include "mkpsolution.h"
+#include "mkpneighbourhood.h"
+#include "elite.h"
+#include "surrogate.h"
+#include "context.h"
+
+/*
+ * Walk from an initiating solution toward a guiding solution.
+ * At each step, one item that is selected by the guiding solution
+ * but not by the current one is added: the most efficient item that
+ * fits if any, the most efficient item otherwise. The current solution
+ * is then repaired by dropping the least efficient items that the guiding
+ * solution does not select. Each intermediate solution is completed
+ * greedily and evaluated; the best one is stored in best.
+ * Returns the objective value of best, or -1 if no intermediate solution
+ * is feasible (the guiding solution is infeasible).
+ *
+ * initiating     : starting point of the path
+ * guiding        : end point of the path
+ * best           : where to store the best intermediate solution
+ * current        : temporary solution (overwritten)
+ * completed      : temporary solution (overwritten)
+ * rank           : rank[j] is the position of item j when items are sorted
+ *                  by decreasing surrogate efficiency
+ * sr             : surrogate relaxation of p
+ * p              : instance of MKP
+ */
+int relink(const solution *initiating,
+           const solution *guiding,
+           solution *best,
+           solution *current,
+           solution *completed,
+           const int *rank,
+           const surrogate *sr,
+           const problem *p);
+
+/*
+ * Post-optimization phase: path relinking between every ordered pair
+ * of elite solutions. Solutions found along the paths are offered to
+ * the pool, and relinking is repeated as long as the best solution
+ * improves and time remains.
+ *
+ * s              : best solution found so far, improved in place.
+ *                  It is offered to the pool beforehand (if feasible).
+ * pool           : elite pool
+ * p              : instance of MKP
+ * max_time       : maximum execution time
+ * ctx            : context where new incumbents are reported (can be NULL)
+ */
+void path_relinking(solution *s, elite_pool *pool, const problem *p, float max_time,
+                    search_context *ctx);
+
+#endif // __RELINKING_H__
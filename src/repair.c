@@ -0,0 +1,156 @@
+/***************************************************************************
+ *   Copyright (C) 2018 Antoine Passemiers                                 *
+ *   apassemi@ulb.ac.be                                                    *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#include "repair.h"
+
+
+repair_engine *create_repair_engine(const problem *p,
+                                    enum repair_order order_mode,
+                                    int add_phase,
+                                    uint64_t *random_state) {
+  repair_engine *r = (repair_engine *)malloc(sizeof(repair_engine));
+  r->order_mode = order_mode;
+  r->add_phase = add_phase;
+  r->n_violated = 0;
+  r->violated = (int *)malloc(p->m * sizeof(int));
+  r->overshoot = (int *)calloc(p->m, sizeof(int));
+  r->order = (int *)malloc(p->n * sizeof(int));
+  r->shuffled = (order_mode == REPAIR_RANDOM) ? (int *)malloc(p->n * sizeof(int)) : NULL;
+  r->u = (float *)malloc(p->m * sizeof(float));
+  r->v = (float *)malloc(p->n * sizeof(float));
+  r->pseudo_utilities = (float *)malloc(p->n * sizeof(float));
+  r->n_repairs = 0;
+  r->random_state = random_state;
+
+  // Static order: pseudo-utilities of the empty solution, where all
+  // constraints weigh the same
+  solution *empty = create_empty_solution(p);
+  compute_pseudo_utilities(r->u, r->v, r->pseudo_utilities, empty, p);
+  indexes_of_sorted_array(r->order, r->pseudo_utilities, p->n);
+  destroy_solution(empty);
+  return(r);
+}
+
+// Weight of an item in a knapsack, for dense instances
+static int dense_weight(const problem *p, int item, int i) {
+  size_t k = (size_t)item * p->m + i;
+  return((p->weights16 != NULL) ? p->weights16[k] : p->weights[k]);
+}
+
+// Whether removing the item reduces the overshoot of a violated constraint
+static int contributes(const repair_engine *r, int item, const problem *p) {
+  if (p->sparse) {
+    for (int k = p->nz_start[item] ; k < p->nz_start[item + 1] ; k++) {
+      if ((p->nz_weights[k] > 0) && (r->overshoot[p->nz_rows[k]] > 0)) return(1);
+    }
+    return(0);
+  }
+  for (int k = 0 ; k < r->n_violated ; k++) {
+    if (dense_weight(p, item, r->violated[k]) > 0) return(1);
+  }
+  return(0);
+}
+
+static void drop(repair_engine *r, solution *s, int item, undo_log *undo, const problem *p) {
+  if (undo != NULL) flip_item(s, item, undo, p);
+  else remove_item(s, item, p);
+  // Only violated constraints can change status
+  if (p->sparse) {
+    for (int k = p->nz_start[item] ; k < p->nz_start[item + 1] ; k++) {
+      int i = p->nz_rows[k];
+      if (r->overshoot[i] <= 0) continue;
+      r->overshoot[i] -= p->nz_weights[k];
+      if (r->overshoot[i] <= 0) {
+        r->overshoot[i] = 0;
+        int v = 0;
+        while (r->violated[v] != i) v++;
+        r->violated[v] = r->violated[--r->n_violated];
+      }
+    }
+    return;
+  }
+  for (int k = 0 ; k < r->n_violated ; ) {
+    int i = r->violated[k];
+    r->overshoot[i] -= dense_weight(p, item, i);
+    if (r->overshoot[i] <= 0) {
+      r->overshoot[i] = 0;
+      r->violated[k] = r->violated[--r->n_violated];
+    } else {
+      k++;
+    }
+  }
+}
+
+int repair_solution(repair_engine *r,
+                    solution *s,
+                    undo_log *undo,
+                    const problem *p) {
+  r->n_violated = 0;
+  for (int i = 0 ; i < p->m ; i++) {
+    int overshoot = s->resources_used[i] - p->capacities[i];
+    r->overshoot[i] = (overshoot > 0) ? overshoot : 0;
+    if (overshoot > 0) r->violated[r->n_violated++] = i;
+  }
+  if (r->n_violated == 0) return(0);
+  r->n_repairs++;
+
+  if (r->order_mode == REPAIR_DYNAMIC) {
+    compute_pseudo_utilities(r->u, r->v, r->pseudo_utilities, s, p);
+    indexes_of_sorted_array(r->order, r->pseudo_utilities, p->n);
+  }
+
+  // DROP phase
+  // Each item is considered once, so the phase ends even when no
+  // selected item can fix the violated constraints
+  const int *drop_order = r->order;
+  if (r->order_mode == REPAIR_RANDOM) {
+    fill_shuffled(r->shuffled, p->n, r->random_state);
+    drop_order = r->shuffled;
+  }
+  for (int k = p->n - 1 ; (k >= 0) && (r->n_violated > 0) ; k--) {
+    int item = drop_order[k];
+    if (s->sol[item] && contributes(r, item, p)) {
+      drop(r, s, item, undo, p);
+    }
+  }
+
+  // ADD phase
+  if (r->add_phase) {
+    for (int k = 0 ; k < p->n ; k++) {
+      int item = r->order[k];
+      if (!check_item(s, item, p)) {
+        if (undo != NULL) flip_item(s, item, undo, p);
+        else add_item(s, item, p);
+      }
+    }
+  }
+  return(1);
+}
+
+void destroy_repair_engine(repair_engine *r) {
+  free(r->violated);
+  free(r->overshoot);
+  free(r->order);
+  free(r->shuffled);
+  free(r->u);
+  free(r->v);
+  free(r->pseudo_utilities);
+  free(r);
+}
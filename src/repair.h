@@ -0,0 +1,101 @@
+/***************************************************************************
+ *   Copyright (C) 2018 Antoine Passemiers                                 *
+ *   apassemi@ulb.ac.be                                                    *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#ifndef __REPAIR_H__
+#define __REPAIR_H__
+
+#include "mkpalgotypes.h"
+#include "mkpsolution.h"
+#include "mkpneighbourhood.h"
+#include "constructive.h"
+
+
+/*
+ * Repair operator turning an infeasible solution into a feasible one.
+ * The constraints violated by the solution and their overshoot
+ * (resources used beyond the capacity) are tracked incrementally while
+ * items are dropped, so that each drop only looks at the constraints
+ * that are still violated.
+ *
+ * order_mode       : order in which items are dropped and added
+ * add_phase        : whether free room is filled after the DROP phase
+ * n_violated       : number of violated constraints
+ * violated         : indices of the violated constraints (first n_violated)
+ * overshoot        : vector of length m containing the overshoot of
+ *                    each constraint (0 if it is satisfied)
+ * order            : vector of length n containing the items by
+ *                    decreasing utility
+ * shuffled         : random permutation of the items walked by the DROP
+ *                    phase with REPAIR_RANDOM (NULL otherwise)
+ * u, v, pseudo_utilities : buffers of compute_pseudo_utilities
+ * n_repairs        : number of infeasible solutions repaired so far
+ * random_state     : state of the random generator drawing the items
+ *                    dropped with REPAIR_RANDOM
+ */
+typedef struct _repair_engine {
+  enum repair_order order_mode;
+  int add_phase;
+  int n_violated;
+  int *violated;
+  int *overshoot;
+  int *order;
+  int *shuffled;
+  float *u;
+  float *v;
+  float *pseudo_utilities;
+  long long n_repairs;
+  uint64_t *random_state;
+} repair_engine;
+
+/*
+ * Create a repair engine for the given instance.
+ *
+ * p                : instance of MKP
+ * order_mode       : order in which items are dropped and added
+ * add_phase        : whether to add items while they fit after the drops
+ * random_state     : state of the random generator, used and advanced by
+ *                    the engine with REPAIR_RANDOM (can be NULL otherwise)
+ */
+repair_engine *create_repair_engine(const problem *p,
+                                    enum repair_order order_mode,
+                                    int add_phase,
+                                    uint64_t *random_state);
+
+/*
+ * Make a solution feasible. Nothing is done if it already is.
+ * DROP phase: selected items contributing to a violated constraint
+ * are removed, least useful first (in random order with REPAIR_RANDOM),
+ * until no constraint is violated or every item has been considered. ADD phase (if enabled): items are
+ * inserted, most useful first, whenever they fit.
+ * Returns 1 if the solution was infeasible, 0 otherwise.
+ *
+ * r                : repair engine
+ * s                : solution to repair in place
+ * undo             : undo log where flips are recorded (can be NULL)
+ * p                : instance of MKP
+ */
+int repair_solution(repair_engine *r,
+                    solution *s,
+                    undo_log *undo,
+                    const problem *p);
+
+void destroy_repair_engine(repair_engine *r);
+
+#endif // __REPAIR_H__
@@ -0,0 +1,181 @@
+/***************************************************************************
+ *   Copyright (C) 2018 Antoine Passemiers                                 *
+ *   apassemi@ulb.ac.be                                                    *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#include "schedule.h"
+#include "annealing.h"
+
+
+// Number of temperature levels that fit in the remaining time,
+// doubling the chain length if there are too many of them
+static double remaining_levels(cooling_schedule *sch, double remaining_time) {
+  double level_duration = sch->chain_length / sch->moves_per_second;
+  if ((sch->level_time > 0) && (level_duration > sch->level_time)) {
+    level_duration = sch->level_time;
+  }
+  double n_levels = remaining_time / level_duration;
+  while (n_levels > SCHEDULE_MAX_LEVELS) {
+    sch->chain_length *= 2;
+    n_levels /= 2;
+  }
+  return((n_levels < 1) ? 1 : n_levels);
+}
+
+cooling_schedule create_cooling_schedule(const sa_config *config) {
+  cooling_schedule sch;
+  memset(&sch, 0x00, sizeof(cooling_schedule));
+  sch.mode = config->cooling;
+  sch.reheat = config->reheat;
+  sch.t0 = config->t0;
+  sch.alpha = config->alpha;
+  sch.t_frozen = config->t_frozen;
+  sch.level_time = -1;
+  return(sch);
+}
+
+void calibrate_schedule(cooling_schedule *sch,
+                        solution *s,
+                        undo_log *undo,
+                        repair_engine *r,
+                        const problem *p,
+                        float max_time,
+                        uint64_t *random_state) {
+  sch->n_steps = 0;
+  sch->n_stagnant = 0;
+  sch->n_reheats = 0;
+  if (sch->mode == FIXED_COOLING) {
+    // If a maximum execution time is provided,
+    // the Markov chain length is set dynamically
+    sch->t = sch->t0;
+    sch->chain_length = (max_time <= 0) ? p->n : INT_MAX;
+    // Number of iterations of the outermost loop required in order
+    // to get a frozen system
+    int k_star = (int)floor(log(sch->t_frozen / sch->t0) / log(sch->alpha));
+    sch->level_time = max_time / (double)k_star;
+    return;
+  }
+
+  // Sample random moves from s and average the worsening deltas
+  double start = wall_time();
+  double sum_worse = 0;
+  int min_worse = INT_MAX;
+  int n_worse = 0;
+  for (int k = 0; k < SCHEDULE_N_SAMPLES; k++) {
+    int value = s->value;
+    annealing_move(s, undo, r, p, random_state);
+    if (s->value < value) {
+      sum_worse += value - s->value;
+      if (value - s->value < min_worse) min_worse = value - s->value;
+      n_worse++;
+    }
+    undo_flips(s, undo, p);
+  }
+  double duration = wall_time() - start;
+  double mean_worse = (n_worse > 0) ? (sum_worse / n_worse) : 1.0;
+  if (n_worse == 0) min_worse = 1;
+
+  // Accepting a worsening move of size d with probability P at
+  // temperature t requires exp(-d / t) = P
+  sch->t0 = mean_worse / log(1.0 / SCHEDULE_P0);
+  sch->t_frozen = min_worse / log(1.0 / SCHEDULE_P_FROZEN);
+  sch->t = sch->t0;
+  sch->t_best = 0;
+  sch->chain_length = p->n;
+  sch->moves_per_second = (duration > 0) ? (SCHEDULE_N_SAMPLES / duration) : 1e9;
+  sch->alpha = 0.95;
+  if (max_time > 0) {
+    // Levels are also bounded in time, in case intensification
+    // makes the steps much slower than the sampled moves
+    sch->level_time = max_time / SCHEDULE_MIN_LEVELS;
+    sch->alpha = pow(sch->t_frozen / sch->t0, 1.0 / remaining_levels(sch, max_time));
+  }
+}
+
+int schedule_frozen(const cooling_schedule *sch, const mkp_timer_t *timer) {
+  if (finished(timer)) return 1;
+  if ((sch->mode == ADAPTIVE_COOLING) && timer->active) return 0;
+  return(sch->t < sch->t_frozen);
+}
+
+void next_temperature(cooling_schedule *sch,
+                      const mkp_timer_t *timer,
+                      float max_time,
+                      int improved) {
+  if (sch->mode == FIXED_COOLING) {
+    sch->t *= sch->alpha;
+    return;
+  }
+
+  // Reheat the system to the temperature at which the best
+  // solution was last improved, if it has been stuck since.
+  // Nothing to go back to if the best solution never improved.
+  if (improved) {
+    sch->t_best = sch->t;
+    sch->n_stagnant = 0;
+  } else {
+    sch->n_stagnant++;
+  }
+  if (sch->reheat && (sch->n_stagnant >= SCHEDULE_STAGNATION) && \
+      (sch->t < sch->t_best)) {
+    sch->t = sch->t_best;
+    sch->n_stagnant = 0;
+    sch->n_reheats++;
+  }
+  if (!timer->active) {
+    sch->t *= sch->alpha;
+    return;
+  }
+
+  // Spread the remaining cooling over the number of levels
+  // that fit in the remaining time at the measured move rate
+  double elapsed = elapsed_time(timer);
+  if (elapsed > 0) sch->moves_per_second = sch->n_steps / elapsed;
+  double n_levels = remaining_levels(sch, max_time - elapsed);
+  sch->alpha = (sch->t > sch->t_frozen) ? pow(sch->t_frozen / sch->t, 1.0 / n_levels) : 1.0;
+  sch->t *= sch->alpha;
+  if (sch->t < sch->t_frozen) sch->t = sch->t_frozen;
+}
+
+void save_schedule(snapshot *s, const cooling_schedule *sch) {
+  save_value(s, "t0", sch->t0);
+  save_value(s, "t_frozen", sch->t_frozen);
+  save_value(s, "alpha", sch->alpha);
+  save_value(s, "t", sch->t);
+  save_value(s, "t_best", sch->t_best);
+  save_value(s, "chain_length", sch->chain_length);
+  save_value(s, "level_time", sch->level_time);
+  save_value(s, "n_steps", sch->n_steps);
+  save_value(s, "moves_per_second", sch->moves_per_second);
+  save_value(s, "n_stagnant", sch->n_stagnant);
+  save_value(s, "n_reheats", sch->n_reheats);
+}
+
+void load_schedule(const snapshot *s, cooling_schedule *sch) {
+  sch->t0 = load_value(s, "t0", sch->t0);
+  sch->t_frozen = load_value(s, "t_frozen", sch->t_frozen);
+  sch->alpha = load_value(s, "alpha", sch->alpha);
+  sch->t = load_value(s, "t", sch->t);
+  sch->t_best = load_value(s, "t_best", sch->t_best);
+  sch->chain_length = (int)load_value(s, "chain_length", sch->chain_length);
+  sch->level_time = (float)load_value(s, "level_time", sch->level_time);
+  sch->n_steps = (long long)load_value(s, "n_steps", sch->n_steps);
+  sch->moves_per_second = load_value(s, "moves_per_second", sch->moves_per_second);
+  sch->n_stagnant = (int)load_value(s, "n_stagnant", sch->n_stagnant);
+  sch->n_reheats = (int)load_value(s, "n_reheats", sch->n_reheats);
+}
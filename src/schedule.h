@@ -0,0 +1,155 @@
+/***************************************************************************
+ *   Copyright (C) 2018 Antoine Passemiers                                 *
+ *   apassemi@ulb.ac.be                                                    *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#ifndef __SCHEDULE_H__
+#define __SCHEDULE_H__
+
+#include "mkpalgotypes.h"
+#include "mkpsolution.h"
+#include "mkpneighbourhood.h"
+#include "repair.h"
+#include "checkpoint.h"
+
+// Number of moves sampled to calibrate the temperatures
+#define SCHEDULE_N_SAMPLES 500
+
+// Acceptance probability of the average sampled worsening at t0
+#define SCHEDULE_P0 0.8
+// Acceptance probability of the smallest sampled worsening at t_frozen
+#define SCHEDULE_P_FROZEN 0.001
+
+// Number of temperature levels without improvement before reheating
+#define SCHEDULE_STAGNATION 20
+
+// With a time limit, each level lasts at most 1 / SCHEDULE_MIN_LEVELS
+// of the time budget
+#define SCHEDULE_MIN_LEVELS 100
+
+// Above this number of remaining levels, the chain length is doubled
+#define SCHEDULE_MAX_LEVELS 2000
+
+/*
+ * Cooling schedule of simulated annealing.
+ *
+ * mode             : FIXED_COOLING or ADAPTIVE_COOLING
+ * reheat           : whether to reheat the system on stagnation
+ *                    (ADAPTIVE_COOLING only)
+ * t0               : initial temperature
+ * t_frozen         : temperature at which the system is frozen
+ * alpha            : current cooling rate
+ * t                : current temperature
+ * t_best           : temperature of the last level improving the best solution
+ * chain_length     : length of the Markov chain of a temperature level.
+ *                    With FIXED_COOLING, it counts accepted moves, with
+ *                    ADAPTIVE_COOLING it counts steps.
+ * level_time       : time budget of a temperature level
+ * n_steps          : number of steps performed so far
+ * moves_per_second : measured number of steps per second
+ * n_stagnant       : number of consecutive levels without improvement
+ * n_reheats        : number of reheats so far
+ */
+typedef struct _cooling_schedule {
+  enum cooling mode;
+  int reheat;
+  double t0;
+  double t_frozen;
+  double alpha;
+  double t;
+  double t_best;
+  int chain_length;
+  float level_time;
+  long long n_steps;
+  double moves_per_second;
+  int n_stagnant;
+  int n_reheats;
+} cooling_schedule;
+
+/*
+ * Create a cooling schedule from the settings of SA. With
+ * ADAPTIVE_COOLING, temperatures are set by calibrate_schedule.
+ *
+ * config           : settings of SA
+ */
+cooling_schedule create_cooling_schedule(const sa_config *config);
+
+/*
+ * Set the initial temperature, frozen temperature, cooling rate and
+ * chain length. With FIXED_COOLING, t0, t_frozen and alpha are those
+ * of the SA settings. With ADAPTIVE_COOLING, random moves are sampled from s:
+ * t0 is the temperature at which the average sampled worsening is
+ * accepted with probability SCHEDULE_P0, t_frozen the one at which the
+ * smallest sampled worsening is accepted with probability
+ * SCHEDULE_P_FROZEN, and the sampling speed gives a first estimate of the move rate,
+ * from which alpha is derived so that t_frozen is reached at the deadline.
+ *
+ * sch              : cooling schedule
+ * s                : current solution (left unchanged)
+ * undo             : empty undo log used to revert sampled moves
+ * r                : repair engine of the moves
+ * p                : instance of MKP
+ * max_time         : time budget of the whole annealing
+ * random_state     : state of the random generator of the moves
+ */
+void calibrate_schedule(cooling_schedule *sch,
+                        solution *s,
+                        undo_log *undo,
+                        repair_engine *r,
+                        const problem *p,
+                        float max_time,
+                        uint64_t *random_state);
+
+/*
+ * Tell whether the annealing is over. With ADAPTIVE_COOLING and a time
+ * limit, the system stays at t_frozen until the deadline.
+ *
+ * sch              : cooling schedule
+ * timer            : timer of the whole annealing
+ */
+int schedule_frozen(const cooling_schedule *sch, const mkp_timer_t *timer);
+
+/*
+ * Move to the next temperature level. With ADAPTIVE_COOLING and a time
+ * limit, the move rate is measured and alpha is recomputed so that the
+ * remaining levels end at t_frozen exactly at the deadline; the chain
+ * length is doubled if too many levels remain. If reheating is enabled,
+ * the temperature goes back to t_best after SCHEDULE_STAGNATION levels
+ * without improvement of the best solution.
+ *
+ * sch              : cooling schedule
+ * timer            : timer of the whole annealing
+ * max_time         : time budget of the whole annealing
+ * improved         : whether the best solution improved during the level
+ */
+void next_temperature(cooling_schedule *sch,
+                      const mkp_timer_t *timer,
+                      float max_time,
+                      int improved);
+
+/*
+ * Save the state of a schedule in a snapshot of SA, or restore it
+ * (mode and reheat come from the settings of SA).
+ *
+ * s                : snapshot of SA
+ * sch              : cooling schedule
+ */
+void save_schedule(snapshot *s, const cooling_schedule *sch);
+void load_schedule(const snapshot *s, cooling_schedule *sch);
+
+#endif // __SCHEDULE_H__
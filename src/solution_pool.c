@@ -0,0 +1,48 @@
+/***************************************************************************
+ *   Copyright (C) 2018 Antoine Passemiers                                 *
+ *   apassemi@ulb.ac.be                                                    *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#include "solution_pool.h"
+
+
+solution_pool *create_solution_pool(int capacity) {
+  solution_pool *pool = (solution_pool *)malloc(sizeof(solution_pool));
+  pool->size = 0;
+  pool->capacity = (capacity > 0) ? capacity : 1;
+  pool->free_list = (solution **)malloc(pool->capacity * sizeof(solution *));
+  pool->n_allocated = 0;
+  return(pool);
+}
+
+solution *acquire_solution(solution_pool *pool, const problem *p) {
+  if (pool->size > 0) return(pool->free_list[--pool->size]);
+  pool->n_allocated++;
+  return(create_empty_solution(p));
+}
+
+void release_solution(solution_pool *pool, solution *s) {
+  if (pool->size < pool->capacity) pool->free_list[pool->size++] = s;
+  else destroy_solution(s);
+}
+
+void destroy_solution_pool(solution_pool *pool) {
+  for (int i = 0 ; i < pool->size ; i++) destroy_solution(pool->free_list[i]);
+  free(pool->free_list);
+  free(pool);
+}
@@ -0,0 +1,78 @@
+/***************************************************************************
+ *   Copyright (C) 2018 Antoine Passemiers                                 *
+ *   apassemi@ulb.ac.be                                                    *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#ifndef __SOLUTION_POOL_H__
+#define __SOLUTION_POOL_H__
+
+#include "mkpsolution.h"
+
+
+/*
+ * Free list of solution buffers of a given instance, so that
+ * algorithms creating many short-lived solutions (e.g. GA offspring)
+ * recycle them instead of allocating and freeing them.
+ *
+ * size           : number of solutions currently available
+ * capacity       : maximum number of solutions kept in the pool
+ * free_list      : available solutions
+ * n_allocated    : number of solutions allocated by the pool so far
+ */
+typedef struct _solution_pool {
+  int size;
+  int capacity;
+  solution **free_list;
+  int n_allocated;
+} solution_pool;
+
+/*
+ * Create an empty pool.
+ *
+ * capacity       : maximum number of solutions kept in the pool.
+ *                  Released solutions beyond it are destroyed.
+ */
+solution_pool *create_solution_pool(int capacity);
+
+/*
+ * Get a solution from the pool, or allocate a new one if the pool is
+ * empty. The contents of a recycled solution are those it had when it
+ * was released: the caller must overwrite them, e.g. with copy_solution,
+ * or by setting sol and calling update_solution.
+ *
+ * pool           : solution pool
+ * p              : instance of MKP
+ */
+solution *acquire_solution(solution_pool *pool, const problem *p);
+
+/*
+ * Give a solution back to the pool. The solution must not be used
+ * by the caller anymore.
+ *
+ * pool           : solution pool
+ * s              : solution to recycle
+ */
+void release_solution(solution_pool *pool, solution *s);
+
+/*
+ * Destroy the pool and the solutions it contains. Solutions acquired
+ * and not released are not affected.
+ */
+void destroy_solution_pool(solution_pool *pool);
+
+#endif // __SOLUTION_POOL_H__
@@ -0,0 +1,187 @@
+/***************************************************************************
+ *   Copyright (C) 2018 Antoine Passemiers                                 *
+ *   apassemi@ulb.ac.be                                                    *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#include <float.h>
+
+#include "surrogate.h"
+
+
+surrogate *create_surrogate(const problem *p, int n_iterations) {
+  surrogate *sr = (surrogate *)malloc(sizeof(surrogate));
+  sr->n = p->n;
+  sr->m = p->m;
+  sr->multipliers = (double *)malloc(p->m * sizeof(double));
+  sr->weights = (double *)malloc(p->n * sizeof(double));
+  sr->order = (int *)malloc(p->n * sizeof(int));
+
+  // Normalized constraints: every knapsack has the same importance
+  for (int i = 0 ; i < p->m ; i++) {
+    sr->multipliers[i] = 1.0 / (double)((p->capacities[i] > 0) ? p->capacities[i] : 1);
+  }
+  update_surrogate(sr, p);
+
+  double *best_multipliers = (double *)malloc(p->m * sizeof(double));
+  double *usage = (double *)malloc(p->m * sizeof(double));
+  memcpy(best_multipliers, sr->multipliers, p->m * sizeof(double));
+  double best_bound = sr->bound;
+
+  for (int it = 0 ; it < n_iterations ; it++) {
+    // Resources consumed by the fractional surrogate solution
+    memset(usage, 0x00, p->m * sizeof(double));
+    double capacity = sr->capacity;
+    for (int k = 0 ; (k < p->n) && (capacity > 0) ; k++) {
+      int j = sr->order[k];
+      double x = (sr->weights[j] <= capacity) ? 1.0 : (capacity / sr->weights[j]);
+      capacity -= x * sr->weights[j];
+      for (int i = 0 ; i < p->m ; i++) usage[i] += x * p->constraints[i][j];
+    }
+    // Multiplicative update: violated constraints get a higher weight,
+    // constraints with slack a lower one. The step size decreases
+    // over the iterations.
+    double step = 1.0 / (1.0 + 0.1 * it);
+    double total = 0.0;
+    for (int i = 0 ; i < p->m ; i++) {
+      double ratio = usage[i] / (double)((p->capacities[i] > 0) ? p->capacities[i] : 1);
+      if (ratio < 1e-3) ratio = 1e-3;
+      sr->multipliers[i] *= pow(ratio, step);
+      total += sr->multipliers[i] * p->capacities[i];
+    }
+    // Surrogate bounds are invariant to scaling: keep total capacity at m
+    for (int i = 0 ; i < p->m ; i++) sr->multipliers[i] *= p->m / total;
+
+    update_surrogate(sr, p);
+    if (sr->bound < best_bound) {
+      best_bound = sr->bound;
+      memcpy(best_multipliers, sr->multipliers, p->m * sizeof(double));
+    }
+  }
+
+  memcpy(sr->multipliers, best_multipliers, p->m * sizeof(double));
+  update_surrogate(sr, p);
+
+  free(best_multipliers);
+  free(usage);
+  return(sr);
+}
+
+void update_surrogate(surrogate *sr, const problem *p) {
+  sr->capacity = 0.0;
+  for (int i = 0 ; i < p->m ; i++) {
+    sr->capacity += sr->multipliers[i] * p->capacities[i];
+  }
+  float *efficiencies = (float *)malloc(p->n * sizeof(float));
+  for (int j = 0 ; j < p->n ; j++) {
+    sr->weights[j] = 0.0;
+    for (int i = 0 ; i < p->m ; i++) {
+      sr->weights[j] += sr->multipliers[i] * p->constraints[i][j];
+    }
+    // Items that consume no resource are always worth taking
+    efficiencies[j] = (sr->weights[j] > 0) ? \
+      (float)(p->profits[j] / sr->weights[j]) : FLT_MAX;
+  }
+  indexes_of_sorted_array(sr->order, efficiencies, p->n);
+  free(efficiencies);
+
+  // Dantzig bound: greedily fill the surrogate knapsack by decreasing
+  // efficiency and take a fraction of the critical item.
+  double capacity = sr->capacity;
+  sr->bound = 0.0;
+  for (int k = 0 ; k < p->n ; k++) {
+    int j = sr->order[k];
+    if (sr->weights[j] <= capacity) {
+      capacity -= sr->weights[j];
+      sr->bound += p->profits[j];
+    } else {
+      sr->bound += p->profits[j] * capacity / sr->weights[j];
+      break;
+    }
+  }
+}
+
+void destroy_surrogate(surrogate *sr) {
+  if (sr->multipliers != NULL) free(sr->multipliers);
+  if (sr->weights != NULL) free(sr->weights);
+  if (sr->order != NULL) free(sr->order);
+  free(sr);
+}
+
+int solve_surrogate_knapsack(const surrogate *sr, const problem *p, int *x) {
+  int n = p->n;
+
+  // Scale surrogate weights so that the table fits in memory
+  double max_capacity = (double)SURROGATE_DP_MAX_BITS / (n > 0 ? n : 1) - 1;
+  if (max_capacity > SURROGATE_DP_MAX_CAPACITY) max_capacity = SURROGATE_DP_MAX_CAPACITY;
+  double scale = (sr->capacity > max_capacity) ? (max_capacity / sr->capacity) : 1.0;
+  int capacity = (int)floor(sr->capacity * scale);
+
+  // Rounding weights up keeps the DP solution feasible for the
+  // real-valued surrogate constraint
+  int *weights = (int *)malloc(n * sizeof(int));
+  for (int j = 0 ; j < n ; j++) weights[j] = (int)ceil(sr->weights[j] * scale - 1e-9);
+
+  int row_words = N_WORDS(capacity + 1);
+  int *values = (int *)calloc(capacity + 1, sizeof(int));
+  uint64_t *keep = (uint64_t *)calloc((size_t)n * row_words, sizeof(uint64_t));
+
+  for (int j = 0 ; j < n ; j++) {
+    int w = weights[j];
+    if (w > capacity) continue;
+    uint64_t *keep_j = keep + (size_t)j * row_words;
+    for (int c = capacity ; c >= w ; c--) {
+      int candidate = values[c - w] + p->profits[j];
+      if (candidate > values[c]) {
+        values[c] = candidate;
+        keep_j[c / 64] |= (1ULL << (c % 64));
+      }
+    }
+  }
+
+  // Backtrack from the full capacity
+  int value = values[capacity];
+  int c = capacity;
+  for (int j = n - 1 ; j >= 0 ; j--) {
+    x[j] = (int)((keep[(size_t)j * row_words + c / 64] >> (c % 64)) & 1ULL);
+    if (x[j]) c -= weights[j];
+  }
+
+  free(weights);
+  free(values);
+  free(keep);
+  return(value);
+}
+
+solution *surrogate_dp_insertion(const problem *p) {
+  surrogate *sr = create_surrogate(p, 100);
+  solution *s = create_empty_solution(p);
+  solve_surrogate_knapsack(sr, p, s->sol);
+  update_solution(s, p);
+
+  // DROP phase: remove the least efficient items until feasible
+  for (int k = p->n - 1 ; (k >= 0) && !is_feasible(s, p) ; k--) {
+    remove_item(s, sr->order[k], p);
+  }
+  // ADD phase: insert the most efficient items while they fit
+  for (int k = 0 ; k < p->n ; k++) {
+    check_and_add_item(s, sr->order[k], p);
+  }
+
+  destroy_surrogate(sr);
+  return(s);
+}
@@ -0,0 +1,112 @@
+/***************************************************************************
+ *   Copyright (C) 2018 Antoine Passemiers                                 *
+ *   apassemi@ulb.ac.be                                                    *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#ifndef __SURROGATE_H__
+#define __SURROGATE_H__
+
+#include "mkpproblem.h"
+#include "mkpneighbourhood.h"
+#include "constructive.h"
+
+// Maximum size (in bits) of the decision table of the surrogate DP
+#define SURROGATE_DP_MAX_BITS (1 << 24)
+
+// Maximum integer capacity of the surrogate DP
+#define SURROGATE_DP_MAX_CAPACITY (1 << 16)
+
+/*
+ * Surrogate relaxation of a MKP instance: the m capacity constraints
+ * are collapsed into a single one by a weighted sum. For any non-negative
+ * multipliers, the optimum of the resulting 0/1 knapsack (and a fortiori
+ * the one of its LP relaxation) is an upper bound on the MKP optimum.
+ *
+ * n              : number of items
+ * m              : number of knapsacks
+ * multipliers    : vector of length m containing the surrogate multipliers
+ * weights        : vector of length n where weights[j] is the surrogate
+ *                  weight of item j (sum_i multipliers[i] * w_ij)
+ * capacity       : surrogate capacity (sum_i multipliers[i] * c_i)
+ * order          : vector of length n containing the items sorted by
+ *                  decreasing surrogate efficiency (profit / surrogate weight)
+ * bound          : value of the LP relaxation of the surrogate knapsack
+ */
+typedef struct _surrogate {
+  int n;
+  int m;
+  double *multipliers;
+  double *weights;
+  double capacity;
+  int *order;
+  double bound;
+} surrogate;
+
+/*
+ * Compute surrogate multipliers for p and build the associated
+ * surrogate knapsack. Multipliers are initialized to 1 / c_i and
+ * refined by a multiplicative update that puts more weight on the
+ * constraints violated by the fractional surrogate solution. The
+ * multipliers giving the tightest bound are kept.
+ *
+ * p              : instance of MKP
+ * n_iterations   : number of multiplier updates (0 keeps 1 / c_i)
+ */
+surrogate *create_surrogate(const problem *p, int n_iterations);
+
+/*
+ * Recompute surrogate weights, capacity, item order and bound
+ * for the current multipliers.
+ *
+ * sr             : surrogate relaxation to update
+ * p              : instance of MKP
+ */
+void update_surrogate(surrogate *sr, const problem *p);
+
+/*
+ * Deallocate a surrogate relaxation.
+ *
+ * sr             : surrogate relaxation to deallocate
+ */
+void destroy_surrogate(surrogate *sr);
+
+/*
+ * Solve the surrogate 0/1 knapsack of sr exactly by dynamic programming.
+ * Surrogate weights are scaled and rounded up to integers so that the
+ * table fits in memory; the DP keeps a single row of values and one
+ * decision bit per (item, capacity) pair for backtracking.
+ * The selected items are written in x (vector of length n).
+ * Returns the objective value of the surrogate knapsack solution.
+ *
+ * sr             : surrogate relaxation of p
+ * p              : instance of MKP
+ * x              : where to write the 0/1 solution of the surrogate knapsack
+ */
+int solve_surrogate_knapsack(const surrogate *sr, const problem *p, int *x);
+
+/*
+ * Create an initial solution to MKP by solving its surrogate knapsack
+ * exactly, then repairing the solution: the least efficient items are
+ * dropped until all constraints are satisfied, and the most efficient
+ * items are added while they fit.
+ *
+ * p : Instance of MKP to solve
+ */
+solution *surrogate_dp_insertion(const problem *p);
+
+#endif // __SURROGATE_H__
@@ -0,0 +1,344 @@
+/***************************************************************************
+ *   Copyright (C) 2018 Antoine Passemiers                                 *
+ *   apassemi@ulb.ac.be                                                    *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+/*
+ * Offline tuner of the GA and SA settings, in the style of F-Race.
+ * Random candidate configurations (plus the default one) are run by the
+ * solver on a sequence of training instances, all with the same seed on
+ * a given instance. After each instance, the candidates are ranked and
+ * the Friedman test, followed by its post-hoc comparisons, eliminates
+ * those that are significantly worse than the best one. The race stops
+ * when a single candidate survives or the budget of runs is spent.
+ *
+ * Usage: mkptune <ga|sa> <path_to_instance> [<path_to_instance> ...]
+ *          [--max-time value] [--candidates value] [--budget value]
+ *          [--jobs value] [--min-stages value] [--seed value]
+ *          [--solver path]
+ */
+
+#include "mkpdata.h"
+#include "utils.h"
+
+// Maximum length of the command line arguments of a candidate
+#define TUNE_MAX_ARGS 256
+
+// Maximum length of a solver command
+#define TUNE_MAX_COMMAND 1024
+
+// Significance level of the statistical tests
+#define TUNE_ALPHA 0.05
+
+
+/*
+ * Candidate configuration of the race.
+ *
+ * args           : command line arguments passed to the solver
+ * alive          : whether the candidate is still racing
+ * values         : objective value reached on each stage
+ */
+typedef struct _candidate {
+  char args[TUNE_MAX_ARGS];
+  int alive;
+  double *values;
+} candidate;
+
+static int uniform_int(int low, int high, uint64_t *random_state) {
+  return(low + random_int(random_state, high - low + 1));
+}
+
+static const char *random_intensification(uint64_t *random_state) {
+  static const char *modes[] = {"always", "near-best", "every", "prob", "never"};
+  return(modes[uniform_int(0, 4, random_state)]);
+}
+
+void sample_ga_candidate(char *args, uint64_t *random_state) {
+  static const int sizes[] = {20, 30, 50, 75, 100, 150, 200, 300, 400};
+  int population_size = sizes[uniform_int(0, 8, random_state)];
+  int tournament_size = uniform_int(2, 8, random_state);
+  snprintf(args, TUNE_MAX_ARGS,
+           "--ga-population %d --ga-mutation %d --ga-tournament %d "
+           "--repair-order %s --intensify %s",
+           population_size, uniform_int(1, 8, random_state), tournament_size,
+           (random_uniform(random_state) < 0.5) ? "dynamic" : "static",
+           random_intensification(random_state));
+}
+
+void sample_sa_candidate(char *args, uint64_t *random_state) {
+  if (random_uniform(random_state) < 0.5) {
+    // Log-uniform initial temperature
+    double t0 = 10.0 * pow(500.0, random_uniform(random_state));
+    snprintf(args, TUNE_MAX_ARGS,
+             "--sa-schedule fixed --sa-t0 %.1f --sa-alpha %.3f --intensify %s",
+             t0, 0.8 + 0.195 * random_uniform(random_state),
+             random_intensification(random_state));
+  } else {
+    snprintf(args, TUNE_MAX_ARGS, "--sa-schedule adaptive%s --intensify %s",
+             (random_uniform(random_state) < 0.5) ? " --reheat" : "",
+             random_intensification(random_state));
+  }
+}
+
+// Write s between single quotes, so that the shell passes it unchanged.
+// Returns 0 if it does not fit in the buffer.
+static int shell_quote(char *buffer, size_t size, const char *s) {
+  size_t k = 0;
+  if (size < 3) return(0);
+  buffer[k++] = '\'';
+  for (; *s != '\0' ; s++) {
+    // A quote closes the quoted string, is escaped, then reopens it
+    const char *piece = (*s == '\'') ? "'\\''" : NULL;
+    size_t length = (piece != NULL) ? strlen(piece) : 1;
+    if (k + length + 2 > size) return(0);
+    if (piece != NULL) memcpy(buffer + k, piece, length);
+    else buffer[k] = *s;
+    k += length;
+  }
+  buffer[k++] = '\'';
+  buffer[k] = '\0';
+  return(1);
+}
+
+// Run the solver on the given candidates in parallel, at most
+// n_jobs processes at a time. Failed or infeasible runs get -1.
+void run_stage(candidate *candidates, int n_candidates, int stage,
+               const char *solver, const char *algorithm, const char *instance,
+               float max_time, int seed, int n_jobs) {
+  FILE **pipes = (FILE **)malloc(n_jobs * sizeof(FILE *));
+  int *running = (int *)malloc(n_jobs * sizeof(int));
+  char command[TUNE_MAX_COMMAND];
+  char quoted_solver[TUNE_MAX_COMMAND], quoted_instance[TUNE_MAX_COMMAND];
+  char line[256];
+  // Paths may contain spaces or characters special to the shell
+  int quoted = shell_quote(quoted_solver, TUNE_MAX_COMMAND, solver) && \
+               shell_quote(quoted_instance, TUNE_MAX_COMMAND, instance);
+
+  for (int c = 0 ; c < n_candidates ; ) {
+    // Start a batch of processes
+    int n_running = 0;
+    for (; (c < n_candidates) && (n_running < n_jobs) ; c++) {
+      if (!candidates[c].alive) continue;
+      int length = snprintf(command, TUNE_MAX_COMMAND, "%s %s %s --terse --max-time %g --seed %d %s",
+                            quoted_solver, quoted_instance, algorithm, max_time, seed,
+                            candidates[c].args);
+      // A truncated command counts as a failed run
+      int fits = quoted && (length < TUNE_MAX_COMMAND);
+      pipes[n_running] = fits ? popen(command, "r") : NULL;
+      running[n_running++] = c;
+    }
+    // Collect their results
+    for (int k = 0 ; k < n_running ; k++) {
+      int value = -1, feasible = 0;
+      if (pipes[k] != NULL) {
+        while (fgets(line, sizeof(line), pipes[k]) != NULL) {
+          sscanf(line, "Solution value: %d", &value);
+          if (strncmp(line, "Solution is feasible.", 21) == 0) feasible = 1;
+        }
+        pclose(pipes[k]);
+      }
+      candidates[running[k]].values[stage] = feasible ? value : -1;
+    }
+  }
+  free(pipes);
+  free(running);
+}
+
+// Quantile of the standard normal distribution (Acklam's approximation)
+double normal_quantile(double q) {
+  static const double a[] = {-3.969683028665376e+01, 2.209460984245205e+02,
+    -2.759285104469687e+02, 1.383577518672690e+02, -3.066479806614716e+01,
+    2.506628277459239e+00};
+  static const double b[] = {-5.447609879822406e+01, 1.615858368580409e+02,
+    -1.556989798598866e+02, 6.680131188771972e+01, -1.328068155288572e+01};
+  static const double c[] = {-7.784894002430293e-03, -3.223964580411365e-01,
+    -2.400758277161838e+00, -2.549732539343734e+00, 4.374664141464968e+00,
+    2.938163982698783e+00};
+  static const double d[] = {7.784695709041462e-03, 3.224671290700398e-01,
+    2.445134137142996e+00, 3.754408661907416e+00};
+  if (q < 0.02425) {
+    double r = sqrt(-2 * log(q));
+    return((((((c[0]*r+c[1])*r+c[2])*r+c[3])*r+c[4])*r+c[5]) /
+           ((((d[0]*r+d[1])*r+d[2])*r+d[3])*r+1));
+  } else if (q > 1 - 0.02425) {
+    return(-normal_quantile(1 - q));
+  }
+  double r = q - 0.5, s = r * r;
+  return((((((a[0]*s+a[1])*s+a[2])*s+a[3])*s+a[4])*s+a[5])*r /
+         (((((b[0]*s+b[1])*s+b[2])*s+b[3])*s+b[4])*s+1));
+}
+
+// Quantile of the chi-squared distribution (Wilson-Hilferty approximation)
+double chi_squared_quantile(double q, int df) {
+  double z = normal_quantile(q);
+  double h = 2.0 / (9.0 * df);
+  return(df * pow(1.0 - h + z * sqrt(h), 3));
+}
+
+// Quantile of Student's t distribution (Cornish-Fisher expansion)
+double student_quantile(double q, int df) {
+  double z = normal_quantile(q);
+  double z3 = z * z * z, z5 = z3 * z * z;
+  return(z + (z3 + z) / (4.0 * df) + (5 * z5 + 16 * z3 + 3 * z) / (96.0 * df * df));
+}
+
+// Sum over the stages of the rank of each alive candidate among the alive
+// ones (1 for the highest value, ties get their average rank).
+// Returns the sum of the squared ranks.
+double rank_candidates(const candidate *candidates, int n_candidates,
+                       int n_stages, double *rank_sums) {
+  double sum_squares = 0;
+  for (int c = 0 ; c < n_candidates ; c++) rank_sums[c] = 0;
+  for (int s = 0 ; s < n_stages ; s++) {
+    for (int c = 0 ; c < n_candidates ; c++) {
+      if (!candidates[c].alive) continue;
+      int better = 0, ties = 0;
+      for (int o = 0 ; o < n_candidates ; o++) {
+        if (!candidates[o].alive || (o == c)) continue;
+        if (candidates[o].values[s] > candidates[c].values[s]) better++;
+        else if (candidates[o].values[s] == candidates[c].values[s]) ties++;
+      }
+      double rank = 1 + better + ties / 2.0;
+      rank_sums[c] += rank;
+      sum_squares += rank * rank;
+    }
+  }
+  return(sum_squares);
+}
+
+// Friedman test over the stages run so far, followed by the elimination
+// of the candidates significantly worse than the best one.
+// Returns the number of eliminated candidates.
+int eliminate(candidate *candidates, int n_candidates, int n_stages, double *rank_sums) {
+  int k = 0;
+  for (int c = 0 ; c < n_candidates ; c++) k += candidates[c].alive;
+  if ((k < 2) || (n_stages < 2)) return(0);
+  int b = n_stages;
+
+  double a = rank_candidates(candidates, n_candidates, n_stages, rank_sums);
+  double c0 = b * k * (k + 1) * (k + 1) / 4.0;
+  if (a - c0 <= 0) return(0); // All candidates are tied
+  double deviation = 0;
+  int best = -1;
+  for (int c = 0 ; c < n_candidates ; c++) {
+    if (!candidates[c].alive) continue;
+    deviation += pow(rank_sums[c] - b * (k + 1) / 2.0, 2);
+    if ((best < 0) || (rank_sums[c] < rank_sums[best])) best = c;
+  }
+  double t = (k - 1) * deviation / (a - c0);
+  if (t <= chi_squared_quantile(1 - TUNE_ALPHA, k - 1)) return(0);
+
+  // Post-hoc comparisons with the best candidate
+  double variance = 2 * b * (1 - t / (b * (k - 1))) * (a - c0) / ((b - 1) * (k - 1));
+  if (variance <= 0) return(0);
+  double threshold = student_quantile(1 - TUNE_ALPHA / 2, (b - 1) * (k - 1)) * sqrt(variance);
+  int n_eliminated = 0;
+  for (int c = 0 ; c < n_candidates ; c++) {
+    if (candidates[c].alive && (rank_sums[c] - rank_sums[best] > threshold)) {
+      candidates[c].alive = 0;
+      n_eliminated++;
+    }
+  }
+  return(n_eliminated);
+}
+
+int main(int argc, char *argv[]) {
+  float max_time = 1.0;
+  int n_candidates = 16;
+  int budget = 200;
+  int n_jobs = 1;
+  int min_stages = 5;
+  int seed = 0;
+  const char *solver = "./mkp";
+  int n_instances = 0;
+  char **instances = (char **)malloc(argc * sizeof(char *));
+  int valid = (argc >= 3) && ((strcmp(argv[1], "ga") == 0) || (strcmp(argv[1], "sa") == 0));
+  for (int i = 2 ; valid && (i < argc) ; i++) {
+    if ((strcmp(argv[i], "--max-time") == 0) && (i + 1 < argc)) max_time = atof(argv[++i]);
+    else if ((strcmp(argv[i], "--candidates") == 0) && (i + 1 < argc)) n_candidates = atoi(argv[++i]);
+    else if ((strcmp(argv[i], "--budget") == 0) && (i + 1 < argc)) budget = atoi(argv[++i]);
+    else if ((strcmp(argv[i], "--jobs") == 0) && (i + 1 < argc)) n_jobs = atoi(argv[++i]);
+    else if ((strcmp(argv[i], "--min-stages") == 0) && (i + 1 < argc)) min_stages = atoi(argv[++i]);
+    else if ((strcmp(argv[i], "--seed") == 0) && (i + 1 < argc)) seed = atoi(argv[++i]);
+    else if ((strcmp(argv[i], "--solver") == 0) && (i + 1 < argc)) solver = argv[++i];
+    else if (strncmp(argv[i], "--", 2) == 0) valid = 0;
+    else instances[n_instances++] = argv[i];
+  }
+  if (!valid || (n_instances == 0) || (n_candidates < 2) || (budget < n_candidates) || \
+      (n_jobs < 1) || (max_time <= 0)) {
+    printf("Usage: mkptune <ga|sa> <path_to_instance> [<path_to_instance> ...] \
+[--max-time value] [--candidates value] [--budget value] [--jobs value] \
+[--min-stages value] [--seed value] [--solver path]\n");
+    free(instances);
+    return(1);
+  }
+  const char *algorithm = argv[1];
+  uint64_t random_state = seed_random_state(seed);
+
+  // The first candidate is the default configuration
+  int max_stages = budget / n_candidates + n_instances;
+  candidate *candidates = (candidate *)malloc(n_candidates * sizeof(candidate));
+  for (int c = 0 ; c < n_candidates ; c++) {
+    candidates[c].args[0] = '\0';
+    if (c > 0) {
+      if (strcmp(algorithm, "ga") == 0) sample_ga_candidate(candidates[c].args, &random_state);
+      else sample_sa_candidate(candidates[c].args, &random_state);
+    }
+    candidates[c].alive = 1;
+    candidates[c].values = (double *)malloc(max_stages * sizeof(double));
+  }
+  double *rank_sums = (double *)malloc(n_candidates * sizeof(double));
+
+  // Training instances are visited in random order, then again
+  // with other seeds if the race is not over
+  int *order = create_shuffled(n_instances, &random_state);
+  int n_alive = n_candidates, n_runs = 0, n_stages = 0;
+  while ((n_alive > 1) && (n_stages < max_stages) && (n_runs + n_alive <= budget)) {
+    const char *instance = instances[order[n_stages % n_instances]];
+    run_stage(candidates, n_candidates, n_stages, solver, algorithm, instance,
+              max_time, seed + n_stages, n_jobs);
+    n_runs += n_alive;
+    n_stages++;
+    if (n_stages >= min_stages) {
+      n_alive -= eliminate(candidates, n_candidates, n_stages, rank_sums);
+    }
+    printf("Stage %d: %s, %d candidates alive, %d runs\n", n_stages, instance, n_alive, n_runs);
+  }
+
+  // Best candidate: lowest sum of ranks among the survivors
+  rank_candidates(candidates, n_candidates, n_stages, rank_sums);
+  int best = -1;
+  printf("\n%-10s %-12s %s\n", "mean rank", "mean value", "configuration");
+  for (int c = 0 ; c < n_candidates ; c++) {
+    if (!candidates[c].alive) continue;
+    double mean = 0;
+    for (int s = 0 ; s < n_stages ; s++) mean += candidates[c].values[s];
+    printf("%-10.2f %-12.1f %s\n", rank_sums[c] / n_stages, mean / n_stages,
+           (c == 0) ? "(default)" : candidates[c].args);
+    if ((best < 0) || (rank_sums[c] < rank_sums[best])) best = c;
+  }
+  printf("\nBest configuration for %s with --max-time %g: %s\n", algorithm, max_time,
+         (best == 0) ? "(default)" : candidates[best].args);
+
+  for (int c = 0 ; c < n_candidates ; c++) free(candidates[c].values);
+  free(candidates);
+  free(rank_sums);
+  free(order);
+  free(instances);
+  return(0);
+}
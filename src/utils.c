@@ -21,87 +21,77 @@
 #include "utils.h"
 
 
-timer_t create_timer(float max_time) {
-  timer_t timer;
-  timer.start = clock();
+double wall_time(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return((double)ts.tv_sec + (double)ts.tv_nsec * 1e-9);
+}
+
+mkp_timer_t create_timer(float max_time) {
+  mkp_timer_t timer;
+  timer.start = wall_time();
   timer.max_time = max_time;
   timer.active = (max_time > 0.0);
+  timer.cancel = NULL;
   return(timer);
 }
 
-int finished(const timer_t *timer) {
+int finished(const mkp_timer_t *timer) {
+  if ((timer->cancel != NULL) && *timer->cancel) return 1;
   if (!timer->active) return 0;
-  return((float)(clock() - timer->start) / CLOCKS_PER_SEC >= timer->max_time);
+  return(elapsed_time(timer) >= timer->max_time);
+}
+
+double elapsed_time(const mkp_timer_t *timer) {
+  return(wall_time() - timer->start);
+}
+
+uint64_t seed_random_state(int seed) {
+  // Spread the seed over the 64 bits of the state
+  uint64_t z = (uint64_t)(unsigned int)seed + 0x9E3779B97F4A7C15ULL;
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+  z ^= z >> 31;
+  return((z == 0) ? 0x9E3779B97F4A7C15ULL : z);
+}
+
+uint64_t random_word(uint64_t *state) {
+  *state ^= *state >> 12;
+  *state ^= *state << 25;
+  *state ^= *state >> 27;
+  return(*state * 0x2545F4914F6CDD1DULL);
+}
+
+double random_uniform(uint64_t *state) {
+  // The 53 high bits give the mantissa of a double in [0, 1)
+  return((double)(random_word(state) >> 11) * (1.0 / 9007199254740992.0));
 }
 
-void set_seed(int seed) {
-  srand(seed);
+int random_int(uint64_t *state, int n) {
+  return((int)(random_word(state) % (uint64_t)n));
 }
 
-int *create_shuffled(int n) {
-  int i, *v = (int *)malloc(n * sizeof(int));
-  for (i = 0; i < n; i++) v[i] = i;
-  shuffle_int(v, n);
+int *create_shuffled(int n, uint64_t *state) {
+  int *v = (int *)malloc(n * sizeof(int));
+  fill_shuffled(v, n, state);
   return(v);
 }
 
-void shuffle_int(int *v, int n) {
+void fill_shuffled(int *v, int n, uint64_t *state) {
+  for (int i = 0; i < n; i++) v[i] = i;
+  shuffle_int(v, n, state);
+}
+
+void shuffle_int(int *v, int n, uint64_t *state) {
   int j, tmp;
   for (int i = n-1; i >= 1; i--) {
-    j = rand() % i;
+    j = random_int(state, i);
     tmp = v[i];
     v[i] = v[j];
     v[j] = tmp;
   }
 }
 
-params *create_parse_error(params *pars) {
-  printf("Error. Calls to MKP Solver must be of the form:\n\n \
-    \tmkp <path_to_instance>  <random|greedy|toyoda|sa|ga> \
-    [--fi|--bi|--vnd] [--max-time value] [--seed value] [--terse]\n");
-  pars->has_parse_error = 1;
-  return(pars);
-}
-
-params *read_params(int argc, char *argv[]) {
-  params *pars = (params *)malloc(sizeof(params));
-  memset(pars, 0x00, sizeof(params));
-  pars->instance_file = argv[1];
-  pars->max_time = -1;
-
-  if (argc < 3) return(create_parse_error(pars));
-  if (strcmp(argv[2], "random") == 0) pars->h = RANDOM;
-  else if (strcmp(argv[2], "greedy") == 0) pars->h = GREEDY;
-  else if (strcmp(argv[2], "toyoda") == 0) pars->h = TOYODA;
-  else if (strcmp(argv[2], "sa") == 0) pars->h = SA;
-  else if (strcmp(argv[2], "ga") == 0) pars->h = GA;
-  else return(create_parse_error(pars));
-
-  for (int i = 3 ; i < argc ; i++) {
-    if (strcmp(argv[i], "--max-time") == 0) {
-      pars->max_time = atof(argv[++i]);
-    } else if (strcmp(argv[i], "--seed") == 0) {
-      pars->seed = atoi(argv[++i]);
-      pars->use_seed = 1;
-    } else if (strcmp(argv[i], "--terse") == 0) {
-      pars->terse = 1;
-    } else if (strcmp(argv[i], "--fi") == 0) {
-      if (pars->use_nm + pars->use_vns) return(create_parse_error(pars));
-      pars->use_nm = 1;
-      pars->nm = FI;
-    } else if (strcmp(argv[i], "--bi") == 0) {
-      if (pars->use_nm + pars->use_vns) return(create_parse_error(pars));
-      pars->use_nm = 1;
-      pars->nm = BI;
-    } else if (strcmp(argv[i], "--vnd") == 0) {
-      if (pars->use_nm + pars->use_vns) return(create_parse_error(pars));
-      pars->use_vns = 1;
-      pars->nm = VND;
-    }
-  }
-  return(pars);
-}
-
 FILE *open_file(char *filename) {
   FILE *input_file;
   printf("\nOpening instance file %s\n\n",filename);
@@ -116,18 +106,30 @@ void close_file(FILE *input_file) {
   fclose(input_file);
 }
 
+// Read the next integer of an instance, exiting if there is none
+static void read_value(FILE *input_file, int *value) {
+  if (fscanf(input_file, "%d", value) != 1) {
+    fprintf(stderr, "error reading input file: truncated or malformed instance\n");
+    exit(1);
+  }
+}
+
 int *read_problem_data(FILE *input_file){
   int *problem_data = (int *) malloc(3 * sizeof(int));
-  fscanf(input_file, "%d", &problem_data[0]);
-  fscanf(input_file, "%d", &problem_data[1]);
-  fscanf(input_file, "%d", &problem_data[2]);
+  read_value(input_file, &problem_data[0]);
+  read_value(input_file, &problem_data[1]);
+  read_value(input_file, &problem_data[2]);
+  if ((problem_data[0] <= 0) || (problem_data[1] <= 0)) {
+    fprintf(stderr, "error reading input file: invalid number of items or knapsacks\n");
+    exit(1);
+  }
   return(problem_data);
 }
 
 int *read_profits(FILE *input_file, int n) {
   int *profits = (int *) malloc(n * sizeof(int));
   for (int i = 0 ; i < n ; i++) {
-    fscanf(input_file, "%d", &profits[i]);
+    read_value(input_file, &profits[i]);
   }
   return(profits);
 }
@@ -139,7 +141,7 @@ int **read_constraints(FILE *input_file, int m, int n) {
   }
   for (int i = 0 ; i < m ; i++) {
     for (int j = 0 ; j < n ; j++) {
-      fscanf(input_file, "%d", &constraints[i][j]);
+      read_value(input_file, &constraints[i][j]);
     }
   }
   return(constraints);
@@ -148,7 +150,7 @@ int **read_constraints(FILE *input_file, int m, int n) {
 int *read_capacities(FILE *input_file, int m) {
   int *capacities = (int *) malloc(m * sizeof(int));
   for (int i = 0 ; i < m ; i++) {
-    fscanf(input_file, "%d", &capacities[i]);
+    read_value(input_file, &capacities[i]);
   }
   return(capacities);
 }
\ No newline at end of file
@@ -28,35 +28,59 @@
 #include <string.h>
 #include <stdlib.h>
 #include <time.h>
+#include <stdint.h>
 
 #include "mkpdata.h"
 
-typedef struct _timer_t {
-  clock_t start;
+/*
+ * Wall-clock timer. Wall time (rather than the CPU time returned by clock())
+ * is used so that the budget keeps its meaning when several threads
+ * are searching at the same time. A timer watching a cancellation
+ * token is also finished once the token is set.
+ */
+typedef struct _mkp_timer_t {
+  double start;
   float max_time;
   int active;
-} timer_t;
+  const cancel_token *cancel;
+} mkp_timer_t;
 
-// initialize custom timer with current time
-timer_t create_timer(float max_time);
+// get current value of a monotonic clock, in seconds
+double wall_time(void);
 
-// check whether timer reached max_time (if it is active)
-int finished(const timer_t *timer);
+// initialize custom timer with current time, watching no token
+mkp_timer_t create_timer(float max_time);
 
-// set the random seed
-void set_seed(int seed);
+// check whether timer reached max_time (if it is active),
+// or whether its cancellation token is set
+int finished(const mkp_timer_t *timer);
 
-// create a vector of n shuffled integers (values from 0 to n-1)
-int *create_shuffled(int n);
+// number of seconds elapsed since the creation of the timer
+double elapsed_time(const mkp_timer_t *timer);
 
-// shuffle vector of n integers
-void shuffle_int(int *vector, int n);
+// state of the random generator (xorshift64*) derived from a seed,
+// never zero. Each solve has its own state, so that concurrent solves
+// do not share a generator.
+uint64_t seed_random_state(int seed);
+
+// draw 64 random bits and advance the state
+uint64_t random_word(uint64_t *state);
+
+// draw a double uniformly in [0, 1)
+double random_uniform(uint64_t *state);
 
-// print error message, show cmd syntax and set error flag in pars
-params *create_parse_error(params *pars);
+// draw an integer uniformly in [0, n)
+int random_int(uint64_t *state, int n);
 
-// read command line parameters: TO BE EXTENDED
-params *read_params(int argc, char *argv[]);
+// create a vector of n shuffled integers (values from 0 to n-1)
+int *create_shuffled(int n, uint64_t *state);
+
+// fill a vector with n shuffled integers (values from 0 to n-1), which
+// only depend on the random state and not on the previous ones
+void fill_shuffled(int *vector, int n, uint64_t *state);
+
+// shuffle vector of n integers
+void shuffle_int(int *vector, int n, uint64_t *state);
 
 
 FILE *open_file(char *filename);